@@ -0,0 +1,23 @@
+#pragma once
+
+#include "grammar.hpp"
+#include "symbol.hpp"
+
+namespace parka {
+
+/**
+ * Sets the alternatives of the add & multiply grammar without left recursion,
+ * shared by the tests and the generator of the checked in parser so they
+ * cannot drift apart.
+ */
+inline void
+set_non_left_recursive_add_multiply_alternatives(Grammar & grammar)
+{
+  grammar.set_alternatives("E"_sym, {"T"_sym + "E'"_sym});
+  grammar.set_alternatives("E'"_sym, {"+"_sym + "T"_sym + "E'"_sym | Symbol::empty()});
+  grammar.set_alternatives("T"_sym, {"F"_sym + "T'"_sym});
+  grammar.set_alternatives("T'"_sym, {"*"_sym + "F"_sym + "T'"_sym | Symbol::empty()});
+  grammar.set_alternatives("F"_sym, {"("_sym + "E"_sym + ")"_sym | "id"_sym});
+}
+
+} // namespace parka
@@ -0,0 +1,337 @@
+// Generated by parka::generate_recursive_descent_parser.  Edit the grammar
+// it was generated from and regenerate it, rather than editing this file.
+#pragma once
+
+#include "grammar.hpp"
+#include "parse_tree.hpp"
+#include "symbol.hpp"
+#include "token.hpp"
+
+#include <vector>
+
+/**
+ * Recursive-descent parser for the grammar with the start symbol "E".
+ */
+class Add_Multiply_Parser {
+public:
+  /**
+   * Calls `visitor` for every terminal and production found while parsing
+   * `tokens`, as `parka::predictive_parse` does.  Returns whether all of the
+   * input up to the right end marker was parsed.
+   */
+  template <typename Iterable_Token_Type, typename Visitor_Functor>
+  static bool
+  parse(Iterable_Token_Type & tokens, Visitor_Functor & visitor)
+  {
+    auto it = tokens.begin();
+    return parse_0(it, visitor) && terminal_of(it->symbol) == terminal_0;
+  }
+
+  /**
+   * Builds the parse tree of `tokens`, as
+   * `parka::predictive_parse_into_parse_tree` does.  Returns null if not all
+   * of the input up to the right end marker could be parsed.
+   */
+  template <typename Iterable_Token_Type, typename Parse_Tree_Builder>
+  static auto
+  parse_into_parse_tree(Iterable_Token_Type & tokens, Parse_Tree_Builder & builder)
+  -> typename Parse_Tree_Builder::value_type
+  {
+    auto it = tokens.begin();
+    auto root = builder.create_node(parka::Token(parka::Symbol("E")));
+    if (!build_0(it, builder, root) || terminal_of(it->symbol) != terminal_0) {
+      return nullptr;
+    }
+    return root;
+  }
+
+private:
+  enum Terminal : unsigned {
+    terminal_0,  // "$"
+    terminal_1,  // "("
+    terminal_2,  // ")"
+    terminal_3,  // "*"
+    terminal_4,  // "+"
+    terminal_5,  // "id"
+    no_terminal
+  };
+
+  /**
+   * The number of the terminal `symbol` is, which the switches use.  Symbol
+   * ids depend on the order names were interned in, so are mapped to these
+   * numbers on first use.
+   */
+  static Terminal
+  terminal_of(parka::Symbol const & symbol)
+  {
+    static std::vector<Terminal> const terminals = [] {
+      char const * const names[] = {
+        "$",
+        "(",
+        ")",
+        "*",
+        "+",
+        "id",
+      };
+      std::vector<Terminal> result;
+      for (unsigned i = 0; i < no_terminal; ++i) {
+        auto const id = parka::Symbol(names[i]).id();
+        if (id >= result.size()) {
+          result.resize(id + 1, no_terminal);
+        }
+        result[id] = static_cast<Terminal>(i);
+      }
+      return result;
+    }();
+    return symbol.id() < terminals.size() ? terminals[symbol.id()] : no_terminal;
+  }
+
+  static parka::Production const &
+  production(unsigned index)
+  {
+    static std::vector<parka::Production> const productions {
+      {parka::Symbol("E"), {parka::Symbol("T"), parka::Symbol("E'")}},
+      {parka::Symbol("E'"), {parka::Symbol("+"), parka::Symbol("T"), parka::Symbol("E'")}},
+      {parka::Symbol("E'"), {parka::Symbol::empty()}},
+      {parka::Symbol("F"), {parka::Symbol("("), parka::Symbol("E"), parka::Symbol(")")}},
+      {parka::Symbol("F"), {parka::Symbol("id")}},
+      {parka::Symbol("T"), {parka::Symbol("F"), parka::Symbol("T'")}},
+      {parka::Symbol("T'"), {parka::Symbol("*"), parka::Symbol("F"), parka::Symbol("T'")}},
+      {parka::Symbol("T'"), {parka::Symbol::empty()}},
+    };
+    return productions[index];
+  }
+
+  template <typename Iterator, typename Visitor_Functor>
+  static bool
+  match(Iterator & it, Visitor_Functor & visitor, Terminal terminal)
+  {
+    if (terminal_of(it->symbol) != terminal) {
+      return false;
+    }
+    visitor(it->symbol);
+    ++it;
+    return true;
+  }
+
+  template <typename Iterator, typename Node>
+  static bool
+  match_into(Iterator & it, Node const & node, Terminal terminal)
+  {
+    if (terminal_of(it->symbol) != terminal) {
+      return false;
+    }
+    node->set_lexeme(it->lexeme);
+    ++it;
+    return true;
+  }
+
+  /**
+   * Gives `node` a child for each symbol of the body of `production`.
+   */
+  template <typename Parse_Tree_Builder>
+  static std::vector<typename Parse_Tree_Builder::value_type>
+  expand(
+      Parse_Tree_Builder & builder
+    , typename Parse_Tree_Builder::value_type const & node
+    , parka::Production const & production)
+  {
+    std::vector<typename Parse_Tree_Builder::value_type> children;
+    children.reserve(production.second.size());
+    for (auto const & symbol : production.second) {
+      children.push_back(builder.create_node(parka::Token(symbol), node));
+    }
+    node->set_children(children);
+    return children;
+  }
+
+  // "E"
+  template <typename Iterator, typename Visitor_Functor>
+  static bool
+  parse_0(Iterator & it, Visitor_Functor & visitor)
+  {
+    switch (terminal_of(it->symbol)) {
+      case terminal_1:  // "("
+      case terminal_5:  // "id"
+        visitor(production(0));
+        return parse_3(it, visitor)
+          && parse_1(it, visitor);
+      default:
+        return false;
+    }
+  }
+
+  // "E'"
+  template <typename Iterator, typename Visitor_Functor>
+  static bool
+  parse_1(Iterator & it, Visitor_Functor & visitor)
+  {
+    switch (terminal_of(it->symbol)) {
+      case terminal_4:  // "+"
+        visitor(production(1));
+        return match(it, visitor, terminal_4)
+          && parse_3(it, visitor)
+          && parse_1(it, visitor);
+      case terminal_0:  // "$"
+      case terminal_2:  // ")"
+        visitor(production(2));
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  // "F"
+  template <typename Iterator, typename Visitor_Functor>
+  static bool
+  parse_2(Iterator & it, Visitor_Functor & visitor)
+  {
+    switch (terminal_of(it->symbol)) {
+      case terminal_1:  // "("
+        visitor(production(3));
+        return match(it, visitor, terminal_1)
+          && parse_0(it, visitor)
+          && match(it, visitor, terminal_2);
+      case terminal_5:  // "id"
+        visitor(production(4));
+        return match(it, visitor, terminal_5);
+      default:
+        return false;
+    }
+  }
+
+  // "T"
+  template <typename Iterator, typename Visitor_Functor>
+  static bool
+  parse_3(Iterator & it, Visitor_Functor & visitor)
+  {
+    switch (terminal_of(it->symbol)) {
+      case terminal_1:  // "("
+      case terminal_5:  // "id"
+        visitor(production(5));
+        return parse_2(it, visitor)
+          && parse_4(it, visitor);
+      default:
+        return false;
+    }
+  }
+
+  // "T'"
+  template <typename Iterator, typename Visitor_Functor>
+  static bool
+  parse_4(Iterator & it, Visitor_Functor & visitor)
+  {
+    switch (terminal_of(it->symbol)) {
+      case terminal_3:  // "*"
+        visitor(production(6));
+        return match(it, visitor, terminal_3)
+          && parse_2(it, visitor)
+          && parse_4(it, visitor);
+      case terminal_0:  // "$"
+      case terminal_2:  // ")"
+      case terminal_4:  // "+"
+        visitor(production(7));
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  // "E"
+  template <typename Iterator, typename Parse_Tree_Builder>
+  static bool
+  build_0(Iterator & it, Parse_Tree_Builder & builder, typename Parse_Tree_Builder::value_type const & node)
+  {
+    switch (terminal_of(it->symbol)) {
+      case terminal_1:  // "("
+      case terminal_5: {  // "id"
+        auto const children = expand(builder, node, production(0));
+        return build_3(it, builder, children[0])
+          && build_1(it, builder, children[1]);
+      }
+      default:
+        return false;
+    }
+  }
+
+  // "E'"
+  template <typename Iterator, typename Parse_Tree_Builder>
+  static bool
+  build_1(Iterator & it, Parse_Tree_Builder & builder, typename Parse_Tree_Builder::value_type const & node)
+  {
+    switch (terminal_of(it->symbol)) {
+      case terminal_4: {  // "+"
+        auto const children = expand(builder, node, production(1));
+        return match_into(it, children[0], terminal_4)
+          && build_3(it, builder, children[1])
+          && build_1(it, builder, children[2]);
+      }
+      case terminal_0:  // "$"
+      case terminal_2:  // ")"
+        expand(builder, node, production(2));
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  // "F"
+  template <typename Iterator, typename Parse_Tree_Builder>
+  static bool
+  build_2(Iterator & it, Parse_Tree_Builder & builder, typename Parse_Tree_Builder::value_type const & node)
+  {
+    switch (terminal_of(it->symbol)) {
+      case terminal_1: {  // "("
+        auto const children = expand(builder, node, production(3));
+        return match_into(it, children[0], terminal_1)
+          && build_0(it, builder, children[1])
+          && match_into(it, children[2], terminal_2);
+      }
+      case terminal_5: {  // "id"
+        auto const children = expand(builder, node, production(4));
+        return match_into(it, children[0], terminal_5);
+      }
+      default:
+        return false;
+    }
+  }
+
+  // "T"
+  template <typename Iterator, typename Parse_Tree_Builder>
+  static bool
+  build_3(Iterator & it, Parse_Tree_Builder & builder, typename Parse_Tree_Builder::value_type const & node)
+  {
+    switch (terminal_of(it->symbol)) {
+      case terminal_1:  // "("
+      case terminal_5: {  // "id"
+        auto const children = expand(builder, node, production(5));
+        return build_2(it, builder, children[0])
+          && build_4(it, builder, children[1]);
+      }
+      default:
+        return false;
+    }
+  }
+
+  // "T'"
+  template <typename Iterator, typename Parse_Tree_Builder>
+  static bool
+  build_4(Iterator & it, Parse_Tree_Builder & builder, typename Parse_Tree_Builder::value_type const & node)
+  {
+    switch (terminal_of(it->symbol)) {
+      case terminal_3: {  // "*"
+        auto const children = expand(builder, node, production(6));
+        return match_into(it, children[0], terminal_3)
+          && build_2(it, builder, children[1])
+          && build_4(it, builder, children[2]);
+      }
+      case terminal_0:  // "$"
+      case terminal_2:  // ")"
+      case terminal_4:  // "+"
+        expand(builder, node, production(7));
+        return true;
+      default:
+        return false;
+    }
+  }
+};
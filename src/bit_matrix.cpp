@@ -0,0 +1,124 @@
+#include "bit_matrix.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace parka {
+
+namespace {
+
+/**
+ * ORs `count` words of `source` into `target`.
+ */
+inline void
+or_words(std::uint64_t * target, std::uint64_t const * source, size_t count)
+{
+  for (size_t i = 0; i < count; ++i) {
+    target[i] |= source[i];
+  }
+}
+
+
+/**
+ * Calls `work(begin, end)` for blocks of the rows [0, rows) on up to
+ * `thread_count` threads, including the calling one.
+ */
+template <typename Work>
+void
+for_row_blocks(size_t rows, size_t thread_count, Work const & work)
+{
+  // Too few rows are not worth starting a thread for.
+  static constexpr size_t min_rows_per_thread = 64;
+
+  if (thread_count == 0) {
+    thread_count = std::thread::hardware_concurrency();
+  }
+  thread_count = std::max<size_t>(1, std::min(thread_count, rows / min_rows_per_thread));
+
+  std::vector<std::thread> workers;
+  auto const rows_per_thread = (rows + thread_count - 1) / thread_count;
+  for (size_t begin = rows_per_thread; begin < rows; begin += rows_per_thread) {
+    workers.emplace_back(work, begin, std::min(rows, begin + rows_per_thread));
+  }
+  work(0, std::min(rows, rows_per_thread));
+  for (auto & worker : workers) {
+    worker.join();
+  }
+}
+
+} // namespace
+
+
+Bit_Matrix::Bit_Matrix(size_t rows, size_t columns)
+  : rows_(rows)
+  , columns_(columns)
+  , words_per_row_((columns + 63) / 64)
+  , words_(rows * words_per_row_, 0)
+{
+}
+
+
+/**
+ * Warshall's algorithm, a 64 column block of intermediate vertices at a time.
+ *
+ * First, the 64 rows of the block are closed over its vertices.  Then each
+ * other row takes in the rows of the block vertices it reaches.  It already
+ * reaches them through the vertices of earlier blocks, and their rows already
+ * hold everything reachable through those and this block's, so one pass over
+ * the block suffices.  The block's rows stay in cache while every other row is
+ * updated, and those other rows are independent of each other, so they are
+ * divided between the threads.
+ */
+void
+Bit_Matrix::transitive_closure(size_t thread_count)
+{
+  for (size_t block = 0; block < words_per_row_; ++block) {
+    auto const block_begin = block * 64;
+    auto const block_end = std::min(rows_, block_begin + 64);
+
+    for (auto k = block_begin; k < block_end; ++k) {
+      for (auto i = block_begin; i < block_end; ++i) {
+        if (test(i, k)) {
+          or_words(row(i), row(k), words_per_row_);
+        }
+      }
+    }
+
+    for_row_blocks(rows_, thread_count, [&](size_t begin, size_t end) {
+      for (auto i = begin; i < end; ++i) {
+        if (i >= block_begin && i < block_end) {
+          continue;
+        }
+        auto reached = row(i)[block];
+        while (reached != 0) {
+          auto const k = block_begin + Bit_Matrix::lowest_bit(reached);
+          reached &= reached - 1;
+          or_words(row(i), row(k), words_per_row_);
+        }
+      }
+    });
+  }
+}
+
+
+Bit_Matrix
+Bit_Matrix::multiply(Bit_Matrix const & right, size_t thread_count) const
+{
+  Bit_Matrix result(rows_, right.columns_);
+  for_row_blocks(rows_, thread_count, [&](size_t begin, size_t end) {
+    for (auto i = begin; i < end; ++i) {
+      auto const left_row = row(i);
+      for (size_t word = 0; word < words_per_row_; ++word) {
+        auto bits = left_row[word];
+        while (bits != 0) {
+          auto const k = word * 64 + Bit_Matrix::lowest_bit(bits);
+          bits &= bits - 1;
+          or_words(result.row(i), right.row(k), result.words_per_row_);
+        }
+      }
+    }
+  });
+  return result;
+}
+
+} // namespace parka
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace parka {
+
+/**
+ * A dense matrix of bits, stored a row at a time in 64 bit words, used to
+ * express relations between symbols.  The row operations work a word at a
+ * time in plain loops, which compilers turn into SIMD instructions.
+ *
+ * The closure and product split their rows into blocks, which may be worked on
+ * by several threads; `thread_count` of 0 uses one per core.
+ */
+class Bit_Matrix {
+  size_t rows_;
+  size_t columns_;
+  size_t words_per_row_;
+  std::vector<std::uint64_t> words_;
+
+public:
+  static size_t lowest_bit(std::uint64_t word)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzll(word));
+#else
+    size_t bit = 0;
+    for (; (word & 1u) == 0; word >>= 1) {
+      ++bit;
+    }
+    return bit;
+#endif
+  }
+
+  Bit_Matrix(size_t rows, size_t columns);
+
+  size_t rows() const { return rows_; }
+  size_t columns() const { return columns_; }
+  size_t words_per_row() const { return words_per_row_; }
+
+  bool test(size_t row, size_t column) const
+  {
+    return (words_[row * words_per_row_ + column / 64] >> (column % 64) & 1u) != 0;
+  }
+
+  void set(size_t row, size_t column)
+  {
+    words_[row * words_per_row_ + column / 64] |= std::uint64_t {1} << (column % 64);
+  }
+
+  std::uint64_t const * row(size_t index) const { return &words_[index * words_per_row_]; }
+  std::uint64_t * row(size_t index) { return &words_[index * words_per_row_]; }
+
+  /**
+   * Calls `function` with the column of each set bit of a row, in order.
+   */
+  template <typename Function>
+  void for_each_in_row(size_t index, Function function) const
+  {
+    auto const words = row(index);
+    for (size_t word = 0; word < words_per_row_; ++word) {
+      for (auto bits = words[word]; bits != 0; bits &= bits - 1) {
+        function(word * 64 + lowest_bit(bits));
+      }
+    }
+  }
+
+  /**
+   * Makes the (square) matrix transitively closed: whenever there is a path
+   * from i to j, (i, j) is set.
+   */
+  void transitive_closure(size_t thread_count = 1);
+
+  /**
+   * The boolean product of this matrix and `right`, whose rows match this
+   * matrix's columns.
+   */
+  Bit_Matrix multiply(Bit_Matrix const & right, size_t thread_count = 1) const;
+
+  bool operator==(Bit_Matrix const & other) const
+  {
+    return rows_ == other.rows_ && columns_ == other.columns_ && words_ == other.words_;
+  }
+
+  bool operator!=(Bit_Matrix const & other) const { return !((*this) == other); }
+};
+
+} // namespace parka
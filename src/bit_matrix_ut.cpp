@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include "bit_matrix.hpp"
+
+#include <random>
+#include <vector>
+using namespace parka;
+
+namespace {
+
+Bit_Matrix
+random_matrix(std::mt19937 & random, size_t rows, size_t columns, unsigned density)
+{
+  Bit_Matrix result(rows, columns);
+  for (size_t i = 0; i < rows; ++i) {
+    for (size_t j = 0; j < columns; ++j) {
+      if (random() % 100 < density) {
+        result.set(i, j);
+      }
+    }
+  }
+  return result;
+}
+
+
+// Reachability by a search from each vertex, to check the closure against.
+Bit_Matrix
+searched_closure(Bit_Matrix const & matrix)
+{
+  Bit_Matrix result(matrix.rows(), matrix.columns());
+  for (size_t start = 0; start < matrix.rows(); ++start) {
+    std::vector<size_t> pending = {start};
+    std::vector<bool> seen(matrix.rows());
+    while (!pending.empty()) {
+      auto const vertex = pending.back();
+      pending.pop_back();
+      matrix.for_each_in_row(vertex, [&](size_t next) {
+        if (!seen[next]) {
+          seen[next] = true;
+          result.set(start, next);
+          pending.push_back(next);
+        }
+      });
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+
+TEST(Bit_Matrix_Test, Set_And_Test) {
+  Bit_Matrix matrix(3, 130);
+  EXPECT_EQ(3u, matrix.words_per_row());
+  matrix.set(1, 0);
+  matrix.set(1, 129);
+  matrix.set(2, 64);
+  EXPECT_TRUE(matrix.test(1, 0));
+  EXPECT_TRUE(matrix.test(1, 129));
+  EXPECT_TRUE(matrix.test(2, 64));
+  EXPECT_FALSE(matrix.test(0, 0));
+  EXPECT_FALSE(matrix.test(2, 63));
+
+  std::vector<size_t> columns;
+  matrix.for_each_in_row(1, [&](size_t column) { columns.push_back(column); });
+  EXPECT_EQ(std::vector<size_t>({0, 129}), columns);
+}
+
+TEST(Bit_Matrix_Test, Chain_Closure) {
+  // 0 -> 1 -> ... -> 199, which needs paths through every block.
+  Bit_Matrix matrix(200, 200);
+  for (size_t i = 0; i + 1 < 200; ++i) {
+    matrix.set(i + 1, i);
+  }
+  matrix.transitive_closure();
+  for (size_t i = 0; i < 200; ++i) {
+    for (size_t j = 0; j < 200; ++j) {
+      ASSERT_EQ(j < i, matrix.test(i, j)) << i << ", " << j;
+    }
+  }
+}
+
+TEST(Bit_Matrix_Test, Closure_Matches_Search) {
+  std::mt19937 random(5);
+  for (size_t size : {1, 2, 63, 64, 65, 150, 300}) {
+    for (unsigned density : {1, 3, 10}) {
+      auto const matrix = random_matrix(random, size, size, density);
+      auto const expected = searched_closure(matrix);
+
+      auto closed = matrix;
+      closed.transitive_closure();
+      EXPECT_EQ(expected, closed) << size << ", " << density;
+
+      auto threaded = matrix;
+      threaded.transitive_closure(4);
+      EXPECT_EQ(expected, threaded) << size << ", " << density;
+    }
+  }
+}
+
+TEST(Bit_Matrix_Test, Multiply) {
+  std::mt19937 random(11);
+  auto const left = random_matrix(random, 150, 90, 5);
+  auto const right = random_matrix(random, 90, 70, 5);
+
+  Bit_Matrix expected(150, 70);
+  for (size_t i = 0; i < 150; ++i) {
+    for (size_t j = 0; j < 70; ++j) {
+      for (size_t k = 0; k < 90; ++k) {
+        if (left.test(i, k) && right.test(k, j)) {
+          expected.set(i, j);
+        }
+      }
+    }
+  }
+  EXPECT_EQ(expected, left.multiply(right));
+  EXPECT_EQ(expected, left.multiply(right, 3));
+}
+
+int main(int argc, char ** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
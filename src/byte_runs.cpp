@@ -0,0 +1,229 @@
+#include "byte_runs.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PARKA_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Only GCC and Clang can compile single functions for AVX2 while the rest of
+// the program targets older CPUs.
+#if PARKA_HAS_SSE2 && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PARKA_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace parka {
+
+constexpr size_t Byte_Ranges::max_ranges;
+
+/**
+ * Splits a set into its ranges of consecutive bytes.  Returns false if there
+ * are too many of them.
+ */
+bool
+Byte_Ranges::from_set(Byte_Set const & bytes, Byte_Ranges * ranges)
+{
+  Byte_Ranges result;
+  size_t byte = 0;
+  while (byte < bytes.size()) {
+    if (!bytes.test(byte)) {
+      ++byte;
+      continue;
+    }
+    if (result.count == max_ranges) {
+      return false;
+    }
+    result.first[result.count] = static_cast<unsigned char>(byte);
+    while (byte < bytes.size() && bytes.test(byte)) {
+      ++byte;
+    }
+    result.last[result.count] = static_cast<unsigned char>(byte - 1);
+    ++result.count;
+  }
+  *ranges = result;
+  return true;
+}
+
+
+namespace {
+
+using Run_Function = char_type const * (*)(char_type const *, char_type const *, Byte_Ranges const &);
+
+
+unsigned
+count_trailing_zeros(unsigned mask)
+{
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+
+char_type const *
+find_run_end_scalar(
+  char_type const * begin,
+  char_type const * end,
+  Byte_Ranges const & ranges)
+{
+  while (begin != end && ranges.contains(*begin)) {
+    ++begin;
+  }
+  return begin;
+}
+
+
+#if PARKA_HAS_SSE2
+char_type const *
+find_run_end_sse2(
+  char_type const * begin,
+  char_type const * end,
+  Byte_Ranges const & ranges)
+{
+  __m128i first[Byte_Ranges::max_ranges];
+  __m128i last[Byte_Ranges::max_ranges];
+  for (size_t i = 0; i < ranges.count; ++i) {
+    first[i] = _mm_set1_epi8(static_cast<char>(ranges.first[i]));
+    last[i] = _mm_set1_epi8(static_cast<char>(ranges.last[i]));
+  }
+
+  while (end - begin >= 16) {
+    auto const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(begin));
+
+    // A byte is within [first, last] if clamping it to the range leaves it
+    // unchanged.  SSE2 only compares bytes as signed, but has unsigned min/max.
+    auto in_run = _mm_setzero_si128();
+    for (size_t i = 0; i < ranges.count; ++i) {
+      auto const clamped = _mm_max_epu8(_mm_min_epu8(bytes, last[i]), first[i]);
+      in_run = _mm_or_si128(in_run, _mm_cmpeq_epi8(clamped, bytes));
+    }
+
+    auto const outside = ~static_cast<unsigned>(_mm_movemask_epi8(in_run)) & 0xFFFFu;
+    if (outside != 0) {
+      return begin + count_trailing_zeros(outside);
+    }
+    begin += 16;
+  }
+  return find_run_end_scalar(begin, end, ranges);
+}
+#endif
+
+
+#if PARKA_HAS_AVX2
+__attribute__((target("avx2")))
+char_type const *
+find_run_end_avx2(
+  char_type const * begin,
+  char_type const * end,
+  Byte_Ranges const & ranges)
+{
+  __m256i first[Byte_Ranges::max_ranges];
+  __m256i last[Byte_Ranges::max_ranges];
+  for (size_t i = 0; i < ranges.count; ++i) {
+    first[i] = _mm256_set1_epi8(static_cast<char>(ranges.first[i]));
+    last[i] = _mm256_set1_epi8(static_cast<char>(ranges.last[i]));
+  }
+
+  while (end - begin >= 32) {
+    auto const bytes = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(begin));
+
+    auto in_run = _mm256_setzero_si256();
+    for (size_t i = 0; i < ranges.count; ++i) {
+      auto const clamped = _mm256_max_epu8(_mm256_min_epu8(bytes, last[i]), first[i]);
+      in_run = _mm256_or_si256(in_run, _mm256_cmpeq_epi8(clamped, bytes));
+    }
+
+    auto const outside = ~static_cast<unsigned>(_mm256_movemask_epi8(in_run));
+    if (outside != 0) {
+      return begin + count_trailing_zeros(outside);
+    }
+    begin += 32;
+  }
+  return find_run_end_sse2(begin, end, ranges);
+}
+#endif
+
+
+Run_Function
+run_function(Run_Kernel kernel)
+{
+  switch (kernel) {
+#if PARKA_HAS_AVX2
+    case Run_Kernel::avx2:
+      return find_run_end_avx2;
+#endif
+#if PARKA_HAS_SSE2
+    case Run_Kernel::sse2:
+      return find_run_end_sse2;
+#endif
+    case Run_Kernel::scalar:
+    default:
+      return find_run_end_scalar;
+  }
+}
+
+} // namespace
+
+
+bool
+run_kernel_is_supported(Run_Kernel kernel)
+{
+  switch (kernel) {
+    case Run_Kernel::avx2:
+#if PARKA_HAS_AVX2
+      return __builtin_cpu_supports("avx2");
+#else
+      return false;
+#endif
+    case Run_Kernel::sse2:
+#if PARKA_HAS_SSE2
+      return true;
+#else
+      return false;
+#endif
+    case Run_Kernel::scalar:
+    default:
+      return true;
+  }
+}
+
+
+Run_Kernel
+best_run_kernel()
+{
+  static auto const best = run_kernel_is_supported(Run_Kernel::avx2) ? Run_Kernel::avx2
+    : run_kernel_is_supported(Run_Kernel::sse2) ? Run_Kernel::sse2
+    : Run_Kernel::scalar;
+  return best;
+}
+
+
+char_type const *
+find_run_end(
+  char_type const * begin,
+  char_type const * end,
+  Byte_Ranges const & ranges)
+{
+  static auto const best = run_function(best_run_kernel());
+  return best(begin, end, ranges);
+}
+
+
+char_type const *
+find_run_end(
+  char_type const * begin,
+  char_type const * end,
+  Byte_Ranges const & ranges,
+  Run_Kernel kernel)
+{
+  return run_function(kernel)(begin, end, ranges);
+}
+
+} // namespace parka
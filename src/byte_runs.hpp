@@ -0,0 +1,70 @@
+#pragma once
+
+#include "string.hpp"
+
+#include <bitset>
+#include <cstddef>
+
+namespace parka {
+
+/**
+ * Membership set over all values of a byte, used for character classes.
+ */
+using Byte_Set = std::bitset<256>;
+
+
+/**
+ * A set of bytes made up of a few inclusive ranges, such as whitespace
+ * (`\t-\n`, `\r`, ` `), identifier characters (`a-z`, `A-Z`, `0-9`, `_`) or
+ * digits, which runs of can be found many bytes at a time.
+ */
+struct Byte_Ranges {
+  static constexpr size_t max_ranges = 4;
+
+  unsigned char first[max_ranges];
+  unsigned char last[max_ranges];
+  size_t count = 0;
+
+  static bool from_set(Byte_Set const & bytes, Byte_Ranges * ranges);
+
+  bool contains(char_type ch) const {
+    auto const byte = static_cast<unsigned char>(ch);
+    for (size_t i = 0; i < count; ++i) {
+      if (byte >= first[i] && byte <= last[i]) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+
+/**
+ * Implementations of `find_run_end`, from slowest to fastest.
+ */
+enum class Run_Kernel {
+  scalar,
+  sse2,
+  avx2
+};
+
+bool run_kernel_is_supported(Run_Kernel kernel);
+Run_Kernel best_run_kernel();
+
+
+/**
+ * Returns the first character in [begin, end) which is not in `ranges`, or
+ * `end` if there is none.  Uses the best kernel supported by the CPU.
+ */
+char_type const * find_run_end(
+    char_type const * begin,
+    char_type const * end,
+    Byte_Ranges const & ranges);
+
+char_type const * find_run_end(
+    char_type const * begin,
+    char_type const * end,
+    Byte_Ranges const & ranges,
+    Run_Kernel kernel);
+
+} // namespace parka
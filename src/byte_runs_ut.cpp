@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include "byte_runs.hpp"
+#include "string.hpp"
+
+#include <cctype>
+#include <random>
+#include <vector>
+using namespace parka;
+
+
+namespace {
+
+Byte_Ranges
+ranges_of(string const & bytes)
+{
+  Byte_Set set;
+  for (auto const ch : bytes) {
+    set.set(static_cast<unsigned char>(ch));
+  }
+  Byte_Ranges ranges;
+  EXPECT_TRUE(Byte_Ranges::from_set(set, &ranges));
+  return ranges;
+}
+
+
+Byte_Ranges
+word_ranges()
+{
+  Byte_Set set;
+  for (size_t byte = 0; byte < 256; ++byte) {
+    set[byte] = std::isalnum(static_cast<int>(byte)) || byte == '_';
+  }
+  Byte_Ranges ranges;
+  EXPECT_TRUE(Byte_Ranges::from_set(set, &ranges));
+  return ranges;
+}
+
+
+std::vector<Run_Kernel>
+supported_kernels()
+{
+  std::vector<Run_Kernel> kernels;
+  for (auto const kernel : {Run_Kernel::scalar, Run_Kernel::sse2, Run_Kernel::avx2}) {
+    if (run_kernel_is_supported(kernel)) {
+      kernels.push_back(kernel);
+    }
+  }
+  return kernels;
+}
+
+} // namespace
+
+
+TEST(Byte_Ranges_Test, From_Set) {
+  auto const whitespace = ranges_of(" \t\r\n");
+  EXPECT_EQ(3u, whitespace.count);
+  EXPECT_TRUE(whitespace.contains('\n'));
+  EXPECT_FALSE(whitespace.contains('\v'));
+
+  auto const word = word_ranges();
+  EXPECT_EQ(4u, word.count);
+  EXPECT_TRUE(word.contains('_'));
+  EXPECT_FALSE(word.contains('-'));
+
+  Byte_Set set;
+  for (size_t byte = 0; byte < 256; byte += 2) {
+    set.set(byte);
+  }
+  Byte_Ranges ranges;
+  EXPECT_FALSE(Byte_Ranges::from_set(set, &ranges));
+  EXPECT_TRUE(Byte_Ranges::from_set(Byte_Set(), &ranges));
+  EXPECT_EQ(0u, ranges.count);
+}
+
+
+TEST(Byte_Runs_Test, Run_Ends) {
+  auto const word = word_ranges();
+  auto const digits = ranges_of("0123456789");
+  string const input = "an_identifier_well_beyond_thirty_two_bytes_long + 12345678901234567890123456789012345 \xff";
+  auto const begin = input.data();
+  auto const end = begin + input.size();
+
+  for (auto const kernel : supported_kernels()) {
+    EXPECT_EQ(input.find(' '), static_cast<size_t>(find_run_end(begin, end, word, kernel) - begin));
+    EXPECT_EQ(begin, find_run_end(begin, end, digits, kernel));
+    auto const number = begin + input.find('1');
+    EXPECT_EQ(input.rfind(' '), static_cast<size_t>(find_run_end(number, end, digits, kernel) - begin));
+    EXPECT_EQ(end, find_run_end(end, end, digits, kernel));
+  }
+}
+
+
+TEST(Byte_Runs_Test, Kernels_Agree) {
+  std::mt19937 random(7);
+  auto const word = word_ranges();
+  auto const high = ranges_of("\x80\x90\xa0\xfe\xff");
+  string const alphabet = "aZ_09 \t-\x80\xff";
+
+  for (size_t trial = 0; trial < 200; ++trial) {
+    string input(random() % 200, 'x');
+    for (auto & ch : input) {
+      // Mostly long runs, with the occasional byte which ends them.
+      ch = random() % 16 == 0 ? alphabet[random() % alphabet.size()] : 'q';
+    }
+    auto const begin = input.data();
+    auto const end = begin + input.size();
+    for (auto const & ranges : {word, high}) {
+      for (auto start = begin; start <= end; start += 1 + random() % 7) {
+        auto const expected = find_run_end(start, end, ranges, Run_Kernel::scalar);
+        for (auto const kernel : supported_kernels()) {
+          EXPECT_EQ(expected, find_run_end(start, end, ranges, kernel)) << input;
+        }
+        EXPECT_EQ(expected, find_run_end(start, end, ranges));
+      }
+    }
+  }
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include "symbol.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace parka {
+
+/**
+ * A set of symbols as a bitset over their interned ids, for the many unions
+ * and membership tests of grammar analysis.  Unions and differences work a
+ * 64 bit word at a time, and report whether they changed the set, which is
+ * what fixed point computations such as FIRST and FOLLOW need to know.
+ *
+ * The set grows to fit the largest id inserted, so is best suited to the
+ * densely numbered symbols of a grammar.  Convert to a `Symbol_Set` when
+ * handing results to users.
+ */
+class Dense_Symbol_Set {
+  std::vector<std::uint64_t> words_;
+
+  static size_t word_of(Symbol const & symbol) { return symbol.id() / 64; }
+  static std::uint64_t bit_of(Symbol const & symbol) { return std::uint64_t {1} << (symbol.id() % 64); }
+
+  static size_t count_bits(std::uint64_t word)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_popcountll(word));
+#else
+    size_t count = 0;
+    for (; word != 0; word &= word - 1) {
+      ++count;
+    }
+    return count;
+#endif
+  }
+
+  static size_t lowest_bit(std::uint64_t word)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzll(word));
+#else
+    size_t bit = 0;
+    for (; (word & 1u) == 0; word >>= 1) {
+      ++bit;
+    }
+    return bit;
+#endif
+  }
+
+public:
+  class const_iterator {
+    std::vector<std::uint64_t> const * words_;
+    size_t word_;
+    std::uint64_t remaining_;
+
+    void skip_empty_words()
+    {
+      while (remaining_ == 0 && ++word_ < words_->size()) {
+        remaining_ = (*words_)[word_];
+      }
+    }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Symbol;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Symbol const *;
+    using reference = Symbol;
+
+    const_iterator(std::vector<std::uint64_t> const & words, size_t word)
+      : words_(&words)
+      , word_(word)
+      , remaining_(word < words.size() ? words[word] : 0)
+    {
+      if (word_ < words_->size()) {
+        skip_empty_words();
+      }
+    }
+
+    Symbol operator*() const
+    {
+      return Symbol::from_id(static_cast<Symbol::id_type>(word_ * 64 + lowest_bit(remaining_)));
+    }
+
+    const_iterator & operator++()
+    {
+      remaining_ &= remaining_ - 1;
+      skip_empty_words();
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      auto const result = *this;
+      ++(*this);
+      return result;
+    }
+
+    bool operator==(const_iterator const & other) const
+    {
+      return word_ == other.word_ && remaining_ == other.remaining_;
+    }
+
+    bool operator!=(const_iterator const & other) const { return !((*this) == other); }
+  };
+
+  Dense_Symbol_Set() = default;
+
+  explicit Dense_Symbol_Set(Symbol_Set const & symbols)
+  {
+    for (auto const & symbol : symbols) {
+      insert(symbol);
+    }
+  }
+
+  bool contains(Symbol const & symbol) const
+  {
+    return word_of(symbol) < words_.size() && (words_[word_of(symbol)] & bit_of(symbol)) != 0;
+  }
+
+  size_t count(Symbol const & symbol) const { return contains(symbol) ? 1 : 0; }
+
+  /**
+   * Adds a symbol, returning true if it was not already present.
+   */
+  bool insert(Symbol const & symbol)
+  {
+    if (word_of(symbol) >= words_.size()) {
+      words_.resize(word_of(symbol) + 1, 0);
+    }
+    auto & word = words_[word_of(symbol)];
+    auto const added = (word & bit_of(symbol)) == 0;
+    word |= bit_of(symbol);
+    return added;
+  }
+
+  /**
+   * Removes a symbol, returning true if it was present.
+   */
+  bool erase(Symbol const & symbol)
+  {
+    if (!contains(symbol)) {
+      return false;
+    }
+    words_[word_of(symbol)] &= ~bit_of(symbol);
+    return true;
+  }
+
+  /**
+   * Adds every symbol of `other`, returning true if any were new.
+   */
+  bool insert_all(Dense_Symbol_Set const & other)
+  {
+    if (other.words_.size() > words_.size()) {
+      words_.resize(other.words_.size(), 0);
+    }
+    std::uint64_t added = 0;
+    for (size_t i = 0; i < other.words_.size(); ++i) {
+      added |= other.words_[i] & ~words_[i];
+      words_[i] |= other.words_[i];
+    }
+    return added != 0;
+  }
+
+  /**
+   * Adds the symbols of `other` which are not in `excluded`, returning true if
+   * any were new.
+   */
+  bool insert_difference(Dense_Symbol_Set const & other, Dense_Symbol_Set const & excluded)
+  {
+    if (other.words_.size() > words_.size()) {
+      words_.resize(other.words_.size(), 0);
+    }
+    std::uint64_t added = 0;
+    for (size_t i = 0; i < other.words_.size(); ++i) {
+      auto const word = other.words_[i] & ~(i < excluded.words_.size() ? excluded.words_[i] : 0);
+      added |= word & ~words_[i];
+      words_[i] |= word;
+    }
+    return added != 0;
+  }
+
+  /**
+   * Removes every symbol of `other`, returning true if any were present.
+   */
+  bool erase_all(Dense_Symbol_Set const & other)
+  {
+    std::uint64_t removed = 0;
+    auto const shared = std::min(words_.size(), other.words_.size());
+    for (size_t i = 0; i < shared; ++i) {
+      removed |= words_[i] & other.words_[i];
+      words_[i] &= ~other.words_[i];
+    }
+    return removed != 0;
+  }
+
+  bool empty() const
+  {
+    for (auto const word : words_) {
+      if (word != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  size_t size() const
+  {
+    size_t result = 0;
+    for (auto const word : words_) {
+      result += count_bits(word);
+    }
+    return result;
+  }
+
+  void clear() { words_.clear(); }
+
+  const_iterator begin() const { return const_iterator(words_, 0); }
+  const_iterator end() const { return const_iterator(words_, words_.size()); }
+
+  Symbol_Set to_symbol_set() const
+  {
+    // Symbol_Set is ordered by id too, so every insertion is at the end.
+    Symbol_Set result;
+    for (auto const symbol : *this) {
+      result.insert(result.end(), symbol);
+    }
+    return result;
+  }
+
+  bool operator==(Dense_Symbol_Set const & other) const
+  {
+    auto const & shorter = words_.size() < other.words_.size() ? words_ : other.words_;
+    auto const & longer = words_.size() < other.words_.size() ? other.words_ : words_;
+    for (size_t i = 0; i < longer.size(); ++i) {
+      if ((i < shorter.size() ? shorter[i] : 0) != longer[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool operator!=(Dense_Symbol_Set const & other) const { return !((*this) == other); }
+};
+
+} // namespace parka
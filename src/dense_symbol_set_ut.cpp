@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "dense_symbol_set.hpp"
+#include "symbol.hpp"
+
+#include <vector>
+using namespace parka;
+
+
+TEST(Dense_Symbol_Set_Test, Insert_Erase) {
+  Dense_Symbol_Set set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_TRUE(set.insert("a"_sym));
+  EXPECT_FALSE(set.insert("a"_sym));
+  EXPECT_TRUE(set.insert(Symbol::empty()));
+  EXPECT_TRUE(set.contains("a"_sym));
+  EXPECT_FALSE(set.contains("b"_sym));
+  EXPECT_EQ(2u, set.size());
+
+  EXPECT_TRUE(set.erase("a"_sym));
+  EXPECT_FALSE(set.erase("a"_sym));
+  EXPECT_EQ(Symbol_Set({Symbol::empty()}), set.to_symbol_set());
+}
+
+
+TEST(Dense_Symbol_Set_Test, Union_And_Difference) {
+  // Enough symbols to span several words.
+  std::vector<Symbol> symbols;
+  for (size_t i = 0; i < 200; ++i) {
+    symbols.push_back(Symbol("dense_" + std::to_string(i)));
+  }
+
+  Dense_Symbol_Set evens;
+  Dense_Symbol_Set odds;
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    (i % 2 == 0 ? evens : odds).insert(symbols[i]);
+  }
+
+  auto all = evens;
+  EXPECT_TRUE(all.insert_all(odds));
+  EXPECT_FALSE(all.insert_all(odds));
+  EXPECT_EQ(symbols.size(), all.size());
+
+  Dense_Symbol_Set some;
+  EXPECT_TRUE(some.insert_difference(all, evens));
+  EXPECT_EQ(odds, some);
+  EXPECT_FALSE(some.insert_difference(all, evens));
+
+  EXPECT_TRUE(all.erase_all(evens));
+  EXPECT_FALSE(all.erase_all(evens));
+  EXPECT_EQ(odds, all);
+  EXPECT_NE(evens, all);
+}
+
+
+TEST(Dense_Symbol_Set_Test, Iterates_In_Symbol_Order) {
+  Symbol_Set const symbols = {"x"_sym, "y"_sym, Symbol::right_end_marker(), Symbol::empty()};
+  Dense_Symbol_Set const set(symbols);
+  EXPECT_EQ(std::vector<Symbol>(symbols.begin(), symbols.end()), std::vector<Symbol>(set.begin(), set.end()));
+  EXPECT_EQ(symbols, set.to_symbol_set());
+
+  // Trailing empty words do not affect equality.
+  auto copy = set;
+  copy.insert(Symbol("dense_far_away"));
+  copy.erase(Symbol("dense_far_away"));
+  EXPECT_EQ(set, copy);
+}
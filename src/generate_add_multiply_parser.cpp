@@ -0,0 +1,32 @@
+#include "add_multiply_grammar.hpp"
+#include "grammar.hpp"
+#include "ll.hpp"
+#include "parser_generator.hpp"
+#include "streams.hpp"
+
+#include <fstream>
+
+using namespace parka;
+
+/**
+ * Writes the recursive-descent parser for the add & multiply grammar of the
+ * tests to the file named by the first argument, or to the standard output.
+ * The `regenerate_parsers` target runs this to update add_multiply_parser.hpp.
+ */
+int
+main(int argc, char ** argv)
+{
+  Grammar grammar;
+  set_non_left_recursive_add_multiply_alternatives(grammar);
+
+  Predictive_Parsing_Table parsing_table;
+  if (!create_predictive_parsing_table(grammar, &parsing_table)) {
+    return 1;
+  }
+
+  if (argc < 2) {
+    return generate_recursive_descent_parser(grammar, parsing_table, "Add_Multiply_Parser", std::cout) ? 0 : 1;
+  }
+  std::ofstream file(argv[1]);
+  return generate_recursive_descent_parser(grammar, parsing_table, "Add_Multiply_Parser", file) && file ? 0 : 1;
+}
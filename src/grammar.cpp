@@ -1,36 +1,250 @@
 #include "grammar.hpp"
 
+#include "bit_matrix.hpp"
 #include "streams.hpp"
+
+#include <algorithm>
+#include <unordered_map>
 #include <utility>
 
 namespace parka {
   Grammar::Grammar()
   : start_symbol_(Symbol::empty())
+  , backend_(Analysis_Backend::worklist)
+  , analysis_thread_count_(1)
+  {
+  }
+
+  void
+  Grammar::set_analysis_backend(Analysis_Backend backend, size_t thread_count)
   {
+    backend_ = backend;
+    analysis_thread_count_ = thread_count;
+    analysis_ = Analysis();
   }
 
-  Symbol_String_Alternatives
+  Symbol_String_Alternatives const &
   Grammar::operator[](Symbol const & symbol) const
   {
+    static Symbol_String_Alternatives const no_alternatives;
     auto it = productions_.find(symbol);
     if (it != productions_.end()) {
       return (it->second);
     }
-    return Symbol_String_Alternatives();
+    return no_alternatives;
   }
 
   void
   Grammar::set_alternatives(
     Symbol const & head,
-    Symbol_String_Alternatives const & alternatives)
+    Symbol_String_Alternatives alternatives)
   {
-    productions_[head] = alternatives;
+    // Taken by value, so alternatives built in the call are moved, not copied.
+    productions_[head] = std::move(alternatives);
+    analysis_ = Analysis();
 
     if (start_symbol_ == Symbol::empty()) {
       start_symbol_ = head;
     }
   }
 
+  /**
+   * Replaces the alternatives of `head`, bringing the analyses up to date by
+   * recomputing only what could depend on them.
+   *
+   * The empty producing symbols and FIRST are solved again only for `head`
+   * and the nonterminals which use it, directly or indirectly.  FOLLOW is
+   * solved again only for the nonterminals whose bodies gained or lost
+   * symbols, or contain a symbol whose FIRST changed, and those their FOLLOW
+   * is passed on to.
+   */
+  Symbol_Set
+  Grammar::update_alternatives(
+    Symbol const & head,
+    Symbol_String_Alternatives alternatives)
+  {
+    // The first alternatives set the start symbol, so everything changes.
+    if (start_symbol_ == Symbol::empty()) {
+      set_alternatives(head, std::move(alternatives));
+      return Symbol_Set {head};
+    }
+
+    analyze_follow();
+    if (!analysis_.has_users) {
+      for (auto const & production : productions_) {
+        count_uses(production.first, production.second, true);
+      }
+      analysis_.has_users = true;
+    }
+    auto const & users = analysis_.users;
+    auto & empty_producing = analysis_.dense_empty_producing;
+    auto & first_map = analysis_.dense_first;
+    auto & follow_map = analysis_.dense_follow;
+
+    auto const was_head = !is_terminal(head);
+    auto & stored = productions_[head];
+    Symbol_Set changed_symbols;
+    for (auto const & alternative : stored) {
+      changed_symbols.insert(alternative.begin(), alternative.end());
+    }
+    count_uses(head, stored, false);
+    stored = std::move(alternatives);
+    count_uses(head, stored, true);
+
+    for (auto const & alternative : stored) {
+      changed_symbols.insert(alternative.begin(), alternative.end());
+      for (auto const & body_symbol : alternative) {
+        if (is_terminal(body_symbol)) {
+          first_map[body_symbol].insert(body_symbol);
+          analysis_.first[body_symbol] = Symbol_Set {body_symbol};
+        }
+      }
+    }
+
+    // Terminals which are no longer used have no FIRST.
+    for (auto const & symbol : changed_symbols) {
+      if (is_terminal(symbol) && users.count(symbol) == 0) {
+        first_map.erase(symbol);
+        analysis_.first.erase(symbol);
+      }
+    }
+
+    // Only `head` and the nonterminals using it can change whether they
+    // produce empty, or their FIRST.
+    vector<Symbol> dependents = {head};
+    Dense_Symbol_Set is_dependent;
+    is_dependent.insert(head);
+    for (size_t i = 0; i < dependents.size(); ++i) {
+      auto const used = users.find(dependents[i]);
+      if (used == users.end()) {
+        continue;
+      }
+      for (auto const & user : used->second) {
+        if (is_dependent.insert(user.first)) {
+          dependents.push_back(user.first);
+        }
+      }
+    }
+
+    vector<Dense_Symbol_Set> old_first;
+    for (auto const & dependent : dependents) {
+      old_first.push_back(first_map[dependent]);
+      empty_producing.erase(dependent);
+    }
+    solve_derivable(dependents, empty_producing);
+    for (auto const & dependent : dependents) {
+      if (empty_producing.contains(dependent)) {
+        analysis_.empty_producing.insert(dependent);
+      }
+      else {
+        analysis_.empty_producing.erase(dependent);
+      }
+    }
+    solve_first(dependents, first_map);
+
+    // Rows for a head depend on FIRST of its bodies and on its FOLLOW.
+    Symbol_Set changed_rows = {head};
+    if (!was_head) {
+      changed_symbols.insert(head);
+    }
+    for (size_t i = 0; i < dependents.size(); ++i) {
+      auto const & dependent = dependents[i];
+      if (first_map[dependent] == old_first[i] && analysis_.first.count(dependent) != 0) {
+        continue;
+      }
+      analysis_.first[dependent] = first_map[dependent].to_symbol_set();
+
+      auto const used = users.find(dependent);
+      if (used == users.end()) {
+        continue;
+      }
+      for (auto const & user : used->second) {
+        for (auto const & alternative : productions_.at(user.first)) {
+          changed_symbols.insert(alternative.begin(), alternative.end());
+
+          // Only the symbols which can start a body affect its FIRST.
+          for (auto const & body_symbol : alternative) {
+            if (body_symbol == dependent) {
+              changed_rows.insert(user.first);
+            }
+            if (!empty_producing.contains(body_symbol)) {
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    // FOLLOW changes for the nonterminals next to changed symbols, and is
+    // passed on to the nonterminals in their bodies.
+    vector<Symbol> targets;
+    Dense_Symbol_Set is_target;
+    for (auto const & symbol : changed_symbols) {
+      if (!is_terminal(symbol) && is_target.insert(symbol)) {
+        targets.push_back(symbol);
+      }
+    }
+    for (size_t i = 0; i < targets.size(); ++i) {
+      for (auto const & alternative : productions_.at(targets[i])) {
+        for (auto const & body_symbol : alternative) {
+          if (!is_terminal(body_symbol) && is_target.insert(body_symbol)) {
+            targets.push_back(body_symbol);
+          }
+        }
+      }
+    }
+
+    vector<Symbol> sources;
+    Dense_Symbol_Set is_source;
+    for (auto const & target : targets) {
+      auto const used = users.find(target);
+      if (used == users.end()) {
+        continue;
+      }
+      for (auto const & user : used->second) {
+        if (is_source.insert(user.first)) {
+          sources.push_back(user.first);
+        }
+      }
+    }
+
+    vector<Dense_Symbol_Set> old_follow;
+    for (auto const & target : targets) {
+      old_follow.push_back(follow_map[target]);
+    }
+    solve_follow(targets, sources, follow_map);
+    for (size_t i = 0; i < targets.size(); ++i) {
+      auto const & target = targets[i];
+      if (follow_map[target] != old_follow[i] || analysis_.follow.count(target) == 0) {
+        analysis_.follow[target] = follow_map[target].to_symbol_set();
+        changed_rows.insert(target);
+      }
+    }
+    return changed_rows;
+  }
+
+  void
+  Grammar::count_uses(
+    Symbol const & head,
+    Symbol_String_Alternatives const & alternatives,
+    bool add)
+  {
+    for (auto const & alternative : alternatives) {
+      for (auto const & body_symbol : alternative) {
+        auto & heads_using = analysis_.users[body_symbol];
+        if (add) {
+          ++heads_using[head];
+        }
+        else if (--heads_using[head] == 0) {
+          heads_using.erase(head);
+          if (heads_using.empty()) {
+            analysis_.users.erase(body_symbol);
+          }
+        }
+      }
+    }
+  }
+
   bool
   Grammar::is_empty_body(Symbol_String const & symbol_string) const
   {
@@ -40,76 +254,167 @@ namespace parka {
   bool
   Grammar::has_empty_production(Symbol const & symbol ) const
   {
-    Symbol_Set empty_production_set = empty_producing_symbols();
-    return empty_production_set.find(symbol) != empty_production_set.end();
+    return analyze_empty_producing().empty_producing.count(symbol) > 0;
+  }
+
+  Symbol_Set const &
+  Grammar::empty_producing_symbols() const
+  {
+    return analyze_empty_producing().empty_producing;
   }
 
   /**
    * Returns the set of symbols which result in an empty production either
    * directly, or indirectly.
-   *
-   * I haven't found (or really looked to be honest) to find how to determine
-   * this from any articles.
-   *
-   * A symbol can possibly result in circular dependencies.  So, we need a way
-   * to determine if a symbol results in eventually producing itself, and also
-   * if it results in producing multiple other symbols as well.  It would seem
-   * that limiting the depth of seach would be prudent, as would be caching the
-   * value produced.
-   *
-   * Examining from empty productions and how they virally expand the production
-   * of empty symbols is an inverted approach that seems simpler than a direct
-   * approach.
-   *
-   * The latter ("inverted") approach is used here.
    */
   Symbol_Set
-  Grammar::empty_producing_symbols() const
+  Grammar::compute_empty_producing_symbols() const
   {
-    Symbol_Set result = {Symbol::empty()};
-    vector<Production> current_possibles;
+    Dense_Symbol_Set result(Symbol_Set {Symbol::empty()});
+    solve_derivable(heads(), result);
+    return result.to_symbol_set();
+  }
 
-    // Initially populate the possible list with the grammar's productions.
-    for (auto const & production : productions_) {
-      for (auto const & body : production.second) {
-        current_possibles.push_back({production.first, body});
+  /**
+   * Adds to `derivable` those of `heads` with a body made up only of symbols
+   * in `derivable`, including those added along the way.  Starting from just
+   * empty, these are the heads which produce empty; starting from the
+   * terminals, those which produce any string of terminals at all.
+   *
+   * Each production counts the symbols of its body not yet known to be
+   * derivable.  Once a symbol is known to be, the counts of the productions
+   * using it drop, and a production whose count reaches zero makes its head
+   * derivable as well.  Every symbol of every body is so visited once, making
+   * this linear in the size of the productions of `heads`.
+   */
+  void
+  Grammar::solve_derivable(
+      vector<Symbol> const & heads,
+      Dense_Symbol_Set & derivable) const
+  {
+    vector<Symbol> production_heads;
+    vector<size_t> remaining;
+    std::unordered_map<Symbol, vector<size_t>> uses;
+    vector<Symbol> found;
+
+    for (auto const & head : heads) {
+      for (auto const & body : productions_.at(head)) {
+        size_t count = 0;
+        for (auto const & symbol : body) {
+          if (!derivable.contains(symbol)) {
+            uses[symbol].push_back(production_heads.size());
+            ++count;
+          }
+        }
+        production_heads.push_back(head);
+        remaining.push_back(count);
+
+        // The body is made up only of derivable symbols already.
+        if (count == 0) {
+          found.push_back(head);
+        }
       }
     }
 
-    vector<Production> next_possibles;
-    bool progress_made = true;
-
-    // Each time around this loop should get quicker has direct productions of
-    // empty are removed.
-    while (progress_made) {
-      next_possibles.clear();
-      progress_made = false;
+    while (!found.empty()) {
+      auto const symbol = found.back();
+      found.pop_back();
+      if (!derivable.insert(symbol)) {
+        continue;
+      }
 
-      for (auto const & production : current_possibles) {
-        // direction production of empty
-        if (is_empty_body(production.second)) {
-          result.insert(production.first);
-          progress_made = true;
+      auto const used = uses.find(symbol);
+      if (used == uses.end()) {
+        continue;
+      }
+      for (auto const production : used->second) {
+        if (--remaining[production] == 0) {
+          found.push_back(production_heads[production]);
         }
-        else {
-          bool all_body_symbols_produce_empty = true;
-          for (auto const & symbol : production.second) {
-            if (result.count(symbol) == 0) {
-              all_body_symbols_produce_empty = false;
-              next_possibles.push_back(production);
-              break;
-            }
+      }
+    }
+  }
+
+  /**
+   * Removes the nonterminals which cannot produce any string of terminals,
+   * along with every production using them, then the nonterminals which can
+   * no longer be reached from the start symbol.  The unproductive ones must
+   * go first, as removing their productions can leave others unreachable.
+   *
+   * If the start symbol itself is unproductive, the grammar produces nothing,
+   * and is left with just the start symbol, without alternatives.
+   */
+  Reduction_Report
+  Grammar::reduce()
+  {
+    Reduction_Report report;
+    analysis_ = Analysis();
+
+    Dense_Symbol_Set productive(Symbol_Set {Symbol::empty()});
+    for (auto const & production : productions_) {
+      for (auto const & alternative : production.second) {
+        for (auto const & body_symbol : alternative) {
+          if (is_terminal(body_symbol)) {
+            productive.insert(body_symbol);
           }
-          // all productions produce empty
-          if (all_body_symbols_produce_empty) {
-            result.insert(production.first);
-            progress_made = true;
+        }
+      }
+    }
+    solve_derivable(heads(), productive);
+
+    for (auto production = productions_.begin(); production != productions_.end();) {
+      auto const & head = production->first;
+      auto & alternatives = production->second;
+      auto const kept = std::stable_partition(alternatives.begin(), alternatives.end(),
+        [&](Symbol_String const & body) {
+          return productive.contains(head) && std::all_of(body.begin(), body.end(),
+            [&](Symbol const & symbol) { return productive.contains(symbol); });
+        });
+      for (auto it = kept; it != alternatives.end(); ++it) {
+        report.removed_productions.emplace_back(head, std::move(*it));
+      }
+      alternatives.erase(kept, alternatives.end());
+
+      if (!productive.contains(head)) {
+        report.unproductive.insert(head);
+        if (head != start_symbol_) {
+          production = productions_.erase(production);
+          continue;
+        }
+      }
+      ++production;
+    }
+
+    // Only the nonterminals which productions of reachable ones use are
+    // reachable.
+    vector<Symbol> reached;
+    Dense_Symbol_Set reachable;
+    if (productions_.count(start_symbol_) != 0) {
+      reached.push_back(start_symbol_);
+      reachable.insert(start_symbol_);
+    }
+    for (size_t i = 0; i < reached.size(); ++i) {
+      for (auto const & alternative : productions_.at(reached[i])) {
+        for (auto const & body_symbol : alternative) {
+          if (!is_terminal(body_symbol) && reachable.insert(body_symbol)) {
+            reached.push_back(body_symbol);
           }
         }
       }
-      std::swap(current_possibles, next_possibles);
     }
-    return result;
+
+    for (auto production = productions_.begin(); production != productions_.end();) {
+      if (reachable.contains(production->first)) {
+        ++production;
+        continue;
+      }
+      report.unreachable.insert(production->first);
+      for (auto & alternative : production->second) {
+        report.removed_productions.emplace_back(production->first, std::move(alternative));
+      }
+      production = productions_.erase(production);
+    }
+    return report;
   }
 
   bool
@@ -117,92 +422,137 @@ namespace parka {
     return productions_.find(symbol) == productions_.end();
   }
 
-  void
-  Grammar::add_terminals_to_first(std::map<Symbol, Symbol_Set> & first_map) const
+  vector<Symbol>
+  Grammar::heads() const
   {
-    // Add all terminal symbols once and head of time since there aren't
-    // production rules for them.
+    vector<Symbol> result;
+    result.reserve(productions_.size());
+    for (auto const & production : productions_) {
+      result.push_back(production.first);
+    }
+    return result;
+  }
+
+  /**
+   * Produces the set of FIRST(X).
+   */
+  Grammar::Dense_Map
+  Grammar::compute_first() const
+  {
+    if (backend_ == Analysis_Backend::bit_matrix) {
+      return first_by_closure();
+    }
+
+    Dense_Map first_map;
     for (auto const & production : productions_) {
       for (auto const & alternative : production.second) {
-        for (auto const & body_symbol : alternative) {
-            if (is_terminal(body_symbol)) {
-              // Prevent adding a symbol multiple times.
-              if (first_map.find(body_symbol) == first_map.end()) {
-                first_map[body_symbol].insert(body_symbol);
-              }
-            }
-        }
+        add_terminals_to_first(alternative, first_map);
+      }
+    }
+    solve_first(heads(), first_map);
+    return first_map;
+  }
+
+  void
+  Grammar::add_terminals_to_first(Symbol_String const & body, Dense_Map & first_map) const
+  {
+    for (auto const & body_symbol : body) {
+      if (is_terminal(body_symbol)) {
+        first_map[body_symbol].insert(body_symbol);
       }
     }
   }
 
   /**
-   * Produces the set of FIRST(X).
+   * Sets FIRST of each of `heads` in `first_map`, which must already hold
+   * FIRST of every other symbol in their bodies.
+   *
+   * FIRST(A) takes in FIRST of each symbol which can start a body of A, so
+   * each of `heads` records which of the others use it that way.  A worklist
+   * then passes FIRST of a head on to those whenever it grows, so only the
+   * sets which may have changed are looked at again.
    */
-  std::map<Symbol, Symbol_Set>
-  Grammar::first() const
+  void
+  Grammar::solve_first(vector<Symbol> const & heads, Dense_Map & first_map) const
   {
-    std::map<Symbol, Symbol_Set> first_map;
-    add_terminals_to_first(first_map);
+    static Dense_Symbol_Set const empty_only(Symbol_Set {Symbol::empty()});
+    auto const & empty_producing = analyze_empty_producing().dense_empty_producing;
+
+    Dense_Symbol_Set solving;
+    for (auto const & head : heads) {
+      solving.insert(head);
+      first_map[head].clear();
+    }
 
-    bool progress_made = true;
-    while (progress_made) {
-      progress_made = false;
+    std::unordered_map<Symbol, vector<Symbol>> users;
+    for (auto const & head : heads) {
+      auto & head_first = first_map[head];
 
-      for (auto const & production : productions_) {
-        auto const & head = production.first;
+      // Only symbols which can produce empty have it in FIRST.
+      if (empty_producing.contains(head)) {
+        head_first.insert(Symbol::empty());
+      }
+
+      // Symbols up to and including the first which cannot produce empty can
+      // start the body.
+      for (auto const & body : productions_.at(head)) {
+        for (auto const & body_symbol : body) {
+          if (solving.contains(body_symbol)) {
+            users[body_symbol].push_back(head);
+          }
+          else {
+            head_first.insert_difference(first_map.at(body_symbol), empty_only);
+          }
 
-        // X can produce empty, so add it to FIRST
-        if (has_empty_production(head)) {
-          if (first_map[head].count(Symbol::empty()) == 0) {
-            first_map[head].insert(Symbol::empty());
-            progress_made = true;
+          if (!empty_producing.contains(body_symbol)) {
+            break;
           }
         }
+      }
+    }
 
-        // Loop through each body for the head symbol.
-        for (auto body : production.second) {
-          // Add FIRST of each symbol, until finding one which blocks the empty
-          // prefix.
-          for (auto const body_symbol : body) {
-            // Adds FIRST(body_symbol) to FIRST(head) since it can appear as the
-            // first non-empty symbol.
-            for (auto const & other : first_map[body_symbol]) {
-              if (first_map[head].count(other) == 0) {
-                first_map[head].insert(other);
-                progress_made = true;
-              }
-            }
+    vector<Symbol> pending(heads);
+    Dense_Symbol_Set is_pending(solving);
+    while (!pending.empty()) {
+      auto const symbol = pending.back();
+      pending.pop_back();
+      is_pending.erase(symbol);
 
-            // The next symbol has no empty productions, so further symbols
-            // do not affect FIRST(head).
-            if (first_map[body_symbol].count(Symbol::empty()) == 0) {
-              break;
-            }
-          }
+      auto const used = users.find(symbol);
+      if (used == users.end()) {
+        continue;
+      }
+      auto const & symbol_first = first_map[symbol];
+      for (auto const & user : used->second) {
+        if (first_map[user].insert_difference(symbol_first, empty_only) && is_pending.insert(user)) {
+          pending.push_back(user);
         }
       }
     }
-    return first_map;
   }
 
-  Symbol_Set
-  Grammar::first(Symbol const & symbol) const
+  /**
+   * FIRST of the symbols in [begin, end), given FIRST of each symbol.
+   */
+  Dense_Symbol_Set
+  Grammar::dense_first(
+    Symbol_String::const_iterator begin,
+    Symbol_String::const_iterator end,
+    Dense_Map const & first_map) const
   {
-    return first()[symbol];
-  }
-
-  Symbol_Set
-  Grammar::first(Symbol_String const & symbol_string) const {
-    Symbol_Set result;
+    Dense_Symbol_Set result;
     bool all_have_empty_in_first = true;
-    for (auto const & symbol : symbol_string) {
-      auto const & symbol_first = first(symbol);
-      result.insert(symbol_first.begin(), symbol_first.end());
+    for (auto it = begin; it != end; ++it) {
+      auto const symbol_first = first_map.find(*it);
+      if (symbol_first == first_map.end()) {
+        all_have_empty_in_first = false;
+        break;
+      }
+      result.insert_all(symbol_first->second);
 
       // Current symbol cannot result in empty, so further symbols cannot affect
       // FIRST for this string
-      if (symbol_first.find(Symbol::empty()) == symbol_first.end()) {
+      if (!symbol_first->second.contains(Symbol::empty())) {
         all_have_empty_in_first = false;
         break;
       }
@@ -219,65 +569,332 @@ namespace parka {
   }
 
   std::map<Symbol, Symbol_Set>
-  Grammar::follow() const
+  Grammar::to_symbol_sets(Dense_Map const & dense_map)
   {
     std::map<Symbol, Symbol_Set> result;
+    for (auto const & entry : dense_map) {
+      result.emplace_hint(result.end(), entry.first, entry.second.to_symbol_set());
+    }
+    return result;
+  }
 
-    result[start_symbol()] = {Symbol::right_end_marker()};
+  Grammar::Analysis const &
+  Grammar::analyze_empty_producing() const
+  {
+    if (!analysis_.has_empty_producing) {
+      analysis_.empty_producing = compute_empty_producing_symbols();
+      analysis_.dense_empty_producing = Dense_Symbol_Set(analysis_.empty_producing);
+      analysis_.has_empty_producing = true;
+    }
+    return analysis_;
+  }
 
-    bool progress_made = true;
-    while (progress_made) {
-      progress_made = false;
-      for (auto const & production : productions_) {
-        auto const & head = production.first;
-        for (auto const & body : production.second) {
-          progress_made = progress_made || add_production_to_follow(head, body, result);
-        }
-      }
+  Grammar::Analysis const &
+  Grammar::analyze_first() const
+  {
+    if (!analysis_.has_first) {
+      analysis_.dense_first = compute_first();
+      analysis_.first = to_symbol_sets(analysis_.dense_first);
+      analysis_.has_first = true;
     }
-    return result;
+    return analysis_;
+  }
+
+  Grammar::Analysis const &
+  Grammar::analyze_follow() const
+  {
+    if (!analysis_.has_follow) {
+      analysis_.dense_follow = compute_follow();
+      analysis_.follow = to_symbol_sets(analysis_.dense_follow);
+      analysis_.has_follow = true;
+    }
+    return analysis_;
+  }
+
+  std::map<Symbol, Symbol_Set> const &
+  Grammar::first() const
+  {
+    return analyze_first().first;
+  }
+
+  Symbol_Set const &
+  Grammar::first(Symbol const & symbol) const
+  {
+    static Symbol_Set const no_symbols;
+    auto const & first_map = analyze_first().first;
+    auto const found = first_map.find(symbol);
+    return found == first_map.end() ? no_symbols : found->second;
   }
 
   Symbol_Set
-  Grammar::follow(Symbol const & symbol) const
+  Grammar::first(Symbol_String const & symbol_string) const {
+    auto const & first_map = analyze_first().dense_first;
+    return dense_first(symbol_string.begin(), symbol_string.end(), first_map).to_symbol_set();
+  }
+
+  /**
+   * Produces the set of FOLLOW(X).
+   */
+  Grammar::Dense_Map
+  Grammar::compute_follow() const
   {
-    // TODO: Add check to ensure symbol is not a terminal.
-    return follow()[symbol];
+    if (backend_ == Analysis_Backend::bit_matrix) {
+      return follow_by_closure();
+    }
+
+    Dense_Map result;
+    result[start_symbol()].insert(Symbol::right_end_marker());
+    auto const all_heads = heads();
+    solve_follow(all_heads, all_heads, result);
+    return result;
   }
 
-  bool
-  Grammar::add_production_to_follow(
-      Symbol const & head,
-      Symbol_String const & body,
-      std::map<Symbol, Symbol_Set> & follow_map) const
+  /**
+   * Sets FOLLOW of each of `targets` in `follow_map`, which must already
+   * hold FOLLOW of every other nonterminal.  `sources` are the heads with a
+   * target in their bodies.
+   *
+   * For each nonterminal B in a body of A, FOLLOW(B) takes in FIRST of the
+   * rest of the body, which is fixed once FIRST is known, and FOLLOW(A) if the
+   * rest of the body can produce empty.  The fixed parts are added in one pass
+   * from the end of each body, then a worklist passes FOLLOW(A) on to each
+   * such B whenever it grows.
+   */
+  void
+  Grammar::solve_follow(
+      vector<Symbol> const & targets,
+      vector<Symbol> const & sources,
+      Dense_Map & follow_map) const
   {
-    bool progress_made = false;
+    static Dense_Symbol_Set const empty_only(Symbol_Set {Symbol::empty()});
+    auto const & first_map = analyze_first().dense_first;
+    auto const & empty_producing = analyze_empty_producing().dense_empty_producing;
+
+    Dense_Symbol_Set solving;
+    for (auto const & target : targets) {
+      solving.insert(target);
+      auto & target_follow = follow_map[target];
+      target_follow.clear();
+      if (target == start_symbol()) {
+        target_follow.insert(Symbol::right_end_marker());
+      }
+    }
 
-    auto it = body.begin();
-    while (it != body.end()) {
-      auto const & current_symbol = *it;
-      ++it;
+    std::unordered_map<Symbol, vector<Symbol>> inheritors;
+    for (auto const & head : sources) {
+      for (auto const & body : productions_.at(head)) {
+        // FIRST of the symbols after the current one.
+        Dense_Symbol_Set rest_first;
+        bool rest_produces_empty = true;
+
+        for (auto it = body.rbegin(); it != body.rend(); ++it) {
+          auto const & current_symbol = *it;
+          if (solving.contains(current_symbol)) {
+            auto & current_follow = follow_map[current_symbol];
+            current_follow.insert_difference(rest_first, empty_only);
+            if (rest_produces_empty) {
+              if (solving.contains(head)) {
+                inheritors[head].push_back(current_symbol);
+              }
+              else {
+                current_follow.insert_all(follow_map[head]);
+              }
+            }
+          }
 
-      if (is_terminal(current_symbol)) {
+          auto const & symbol_first = first_map.at(current_symbol);
+          if (empty_producing.contains(current_symbol)) {
+            rest_first.insert_all(symbol_first);
+          }
+          else {
+            rest_first = symbol_first;
+            rest_produces_empty = false;
+          }
+        }
+      }
+    }
+
+    vector<Symbol> pending(targets);
+    Dense_Symbol_Set is_pending(solving);
+    while (!pending.empty()) {
+      auto const symbol = pending.back();
+      pending.pop_back();
+      is_pending.erase(symbol);
+
+      auto const inheriting = inheritors.find(symbol);
+      if (inheriting == inheritors.end()) {
         continue;
       }
+      auto const & symbol_follow = follow_map[symbol];
+      for (auto const & inheritor : inheriting->second) {
+        if (follow_map[inheritor].insert_all(symbol_follow) && is_pending.insert(inheritor)) {
+          pending.push_back(inheritor);
+        }
+      }
+    }
+  }
+
+  /**
+   * Produces FIRST(X) from the relation "A starts with B", for when B can start
+   * a body of A.  Its reflexive transitive closure, multiplied by the
+   * terminals each nonterminal starts with directly, gives FIRST.
+   */
+  Grammar::Dense_Map
+  Grammar::first_by_closure() const
+  {
+    auto const & empty_producing = analyze_empty_producing().dense_empty_producing;
+    auto const all_heads = heads();
+    std::unordered_map<Symbol, size_t> head_index;
+    for (size_t i = 0; i < all_heads.size(); ++i) {
+      head_index.emplace(all_heads[i], i);
+    }
+
+    Dense_Map first_map;
+    vector<Symbol> terminals;
+    std::unordered_map<Symbol, size_t> terminal_index;
+    for (auto const & production : productions_) {
+      for (auto const & alternative : production.second) {
+        add_terminals_to_first(alternative, first_map);
+        for (auto const & body_symbol : alternative) {
+          if (is_terminal(body_symbol) && body_symbol != Symbol::empty()
+              && terminal_index.emplace(body_symbol, terminals.size()).second) {
+            terminals.push_back(body_symbol);
+          }
+        }
+      }
+    }
+
+    Bit_Matrix starts_with(all_heads.size(), all_heads.size());
+    Bit_Matrix starts_with_terminal(all_heads.size(), terminals.size());
+    for (size_t i = 0; i < all_heads.size(); ++i) {
+      starts_with.set(i, i);
+      for (auto const & body : productions_.at(all_heads[i])) {
+        for (auto const & body_symbol : body) {
+          if (!is_terminal(body_symbol)) {
+            starts_with.set(i, head_index.at(body_symbol));
+          }
+          else if (body_symbol != Symbol::empty()) {
+            starts_with_terminal.set(i, terminal_index.at(body_symbol));
+          }
+
+          if (!empty_producing.contains(body_symbol)) {
+            break;
+          }
+        }
+      }
+    }
+
+    starts_with.transitive_closure(analysis_thread_count_);
+    auto const first = starts_with.multiply(starts_with_terminal, analysis_thread_count_);
+    for (size_t i = 0; i < all_heads.size(); ++i) {
+      auto & head_first = first_map[all_heads[i]];
+      if (empty_producing.contains(all_heads[i])) {
+        head_first.insert(Symbol::empty());
+      }
+      first.for_each_in_row(i, [&](size_t terminal) {
+        head_first.insert(terminals[terminal]);
+      });
+    }
+    return first_map;
+  }
+
+  /**
+   * Produces FOLLOW(X) from the relation "B inherits from A", for when B ends
+   * a body of A, other than symbols which can produce empty.  Its reflexive
+   * transitive closure, multiplied by the terminals each nonterminal is
+   * directly followed by, gives FOLLOW.
+   */
+  Grammar::Dense_Map
+  Grammar::follow_by_closure() const
+  {
+    auto const & first_map = analyze_first().dense_first;
+    auto const & empty_producing = analyze_empty_producing().dense_empty_producing;
+
+    Dense_Map result;
+    result[start_symbol()].insert(Symbol::right_end_marker());
+    if (productions_.empty()) {
+      return result;
+    }
+
+    auto const all_heads = heads();
+    std::unordered_map<Symbol, size_t> head_index;
+    for (size_t i = 0; i < all_heads.size(); ++i) {
+      head_index.emplace(all_heads[i], i);
+    }
+
+    vector<Symbol> terminals = {Symbol::right_end_marker()};
+    std::unordered_map<Symbol, size_t> terminal_index = {{Symbol::right_end_marker(), 0}};
+    for (auto const & production : productions_) {
+      for (auto const & alternative : production.second) {
+        for (auto const & body_symbol : alternative) {
+          if (is_terminal(body_symbol) && body_symbol != Symbol::empty()
+              && terminal_index.emplace(body_symbol, terminals.size()).second) {
+            terminals.push_back(body_symbol);
+          }
+        }
+      }
+    }
 
-      auto const first_right_side = first(Symbol_String(it, body.end()));
-      auto const & follow_a = follow_map[head];
-      auto & follow_b = follow_map[current_symbol];
+    Bit_Matrix inherits(all_heads.size(), all_heads.size());
+    Bit_Matrix followed_by(all_heads.size(), terminals.size());
+    followed_by.set(head_index.at(start_symbol()), 0);
+    for (size_t i = 0; i < all_heads.size(); ++i) {
+      inherits.set(i, i);
+      for (auto const & body : productions_.at(all_heads[i])) {
+        // FIRST of the symbols after the current one.
+        Dense_Symbol_Set rest_first;
+        bool rest_produces_empty = true;
+
+        for (auto it = body.rbegin(); it != body.rend(); ++it) {
+          auto const & current_symbol = *it;
+          if (!is_terminal(current_symbol)) {
+            auto const current = head_index.at(current_symbol);
+            for (auto const follower : rest_first) {
+              if (follower != Symbol::empty()) {
+                followed_by.set(current, terminal_index.at(follower));
+              }
+            }
+            if (rest_produces_empty) {
+              inherits.set(current, i);
+            }
+          }
 
-      // Adds all of FOLLOW(A) to FOLLOW(B)
-      if (first_right_side.count(Symbol::empty()) > 0) {
-        auto const size_before_adding_follow_a = follow_b.size();
-        follow_b.insert(follow_a.begin(), follow_a.end());
-        progress_made = progress_made || (follow_b.size() != size_before_adding_follow_a);
+          auto const & symbol_first = first_map.at(current_symbol);
+          if (empty_producing.contains(current_symbol)) {
+            rest_first.insert_all(symbol_first);
+          }
+          else {
+            rest_first = symbol_first;
+            rest_produces_empty = false;
+          }
+        }
       }
+    }
 
-      auto const size_before_adding_first_beta = follow_b.size();
-      follow_b.insert(first_right_side.begin(), first_right_side.end());
-      follow_b.erase(Symbol::empty());
-      progress_made = progress_made || (follow_b.size() != size_before_adding_first_beta);
+    inherits.transitive_closure(analysis_thread_count_);
+    auto const follow = inherits.multiply(followed_by, analysis_thread_count_);
+    for (size_t i = 0; i < all_heads.size(); ++i) {
+      auto & head_follow = result[all_heads[i]];
+      follow.for_each_in_row(i, [&](size_t terminal) {
+        head_follow.insert(terminals[terminal]);
+      });
     }
-    return progress_made;
+    return result;
+  }
+
+  std::map<Symbol, Symbol_Set> const &
+  Grammar::follow() const
+  {
+    return analyze_follow().follow;
+  }
+
+  Symbol_Set const &
+  Grammar::follow(Symbol const & symbol) const
+  {
+    // TODO: Add check to ensure symbol is not a terminal.
+    static Symbol_Set const no_symbols;
+    auto const & follow_map = analyze_follow().follow;
+    auto const found = follow_map.find(symbol);
+    return found == follow_map.end() ? no_symbols : found->second;
   }
 }
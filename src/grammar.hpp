@@ -1,51 +1,176 @@
 #pragma once
 
+#include "dense_symbol_set.hpp"
 #include "symbol.hpp"
 
+#include <cstddef>
 #include <map>
+#include <unordered_map>
 
 namespace parka {
 
 using Production = std::pair<Symbol, Symbol_String>;
 
+/**
+ * The algorithms a Grammar computes FIRST and FOLLOW with.  Both give the
+ * same results.
+ */
+enum class Analysis_Backend {
+  /// Pass sets along the dependencies between symbols until none grow.
+  worklist,
+
+  /// Close the dependencies as relations on bit matrices, which suits very
+  /// large grammars, and can use several threads.
+  bit_matrix
+};
+
+/**
+ * What `Grammar::reduce` removed.
+ */
+struct Reduction_Report {
+  /// Nonterminals which produce no string of terminals.
+  Symbol_Set unproductive;
+
+  /// Nonterminals which no string derived from the start symbol contains.
+  Symbol_Set unreachable;
+
+  /// Productions removed, for either reason.
+  vector<Production> removed_productions;
+
+  bool empty() const { return removed_productions.empty() && unproductive.empty() && unreachable.empty(); }
+};
+
+
+/**
+ * A context free grammar, as the alternative bodies of each nonterminal.
+ *
+ * The analyses (the empty producing symbols, FIRST and FOLLOW) are computed
+ * once, on the first query needing them, and kept until `set_alternatives`
+ * changes the grammar; later queries just look up the results.  Since queries
+ * fill these in, a Grammar must not be queried from several threads at once
+ * unless it has already been analysed.
+ *
+ * `update_alternatives` changes a grammar while keeping its analyses,
+ * recomputing just the parts that depend on the changed nonterminal.
+ *
+ * Alternatives and analysis results are returned by reference, so may be
+ * walked without copying.  They stay valid until the grammar is changed.
+ */
 class Grammar {
   Symbol start_symbol_;
   std::map<Symbol, Symbol_String_Alternatives> productions_;
 
-  void add_terminals_to_first(std::map<Symbol, Symbol_Set> & first_map) const;
-  bool add_production_to_follow(
-      Symbol const & head,
-      Symbol_String const & body,
-      std::map<Symbol, Symbol_Set> & follow_map) const;
+  Analysis_Backend backend_;
+  size_t analysis_thread_count_;
+
+  using Dense_Map = std::map<Symbol, Dense_Symbol_Set>;
+
+  /**
+   * Results of analysing the productions, each computed when first needed and
+   * discarded whenever the productions change.
+   */
+  struct Analysis {
+    bool has_empty_producing = false;
+    Symbol_Set empty_producing;
+    Dense_Symbol_Set dense_empty_producing;
+
+    bool has_first = false;
+    Dense_Map dense_first;
+    std::map<Symbol, Symbol_Set> first;
+
+    bool has_follow = false;
+    Dense_Map dense_follow;
+    std::map<Symbol, Symbol_Set> follow;
+
+    // For each symbol, the number of times each head uses it in its bodies,
+    // kept only once alternatives are updated.
+    bool has_users = false;
+    std::unordered_map<Symbol, std::unordered_map<Symbol, size_t>> users;
+  };
+  mutable Analysis analysis_;
+
+  vector<Symbol> heads() const;
+  void count_uses(Symbol const & head, Symbol_String_Alternatives const & alternatives, bool add);
+
+  Symbol_Set compute_empty_producing_symbols() const;
+  Dense_Map compute_first() const;
+  Dense_Map compute_follow() const;
+
+  void solve_derivable(vector<Symbol> const & heads, Dense_Symbol_Set & derivable) const;
+  void add_terminals_to_first(Symbol_String const & body, Dense_Map & first_map) const;
+  void solve_first(vector<Symbol> const & heads, Dense_Map & first_map) const;
+  void solve_follow(
+      vector<Symbol> const & targets,
+      vector<Symbol> const & sources,
+      Dense_Map & follow_map) const;
+
+  Dense_Map first_by_closure() const;
+  Dense_Map follow_by_closure() const;
+
+  Analysis const & analyze_empty_producing() const;
+  Analysis const & analyze_first() const;
+  Analysis const & analyze_follow() const;
+
+  Dense_Symbol_Set dense_first(
+      Symbol_String::const_iterator begin,
+      Symbol_String::const_iterator end,
+      Dense_Map const & first_map) const;
+
+  static std::map<Symbol, Symbol_Set> to_symbol_sets(Dense_Map const & dense_map);
 
 public:
   Grammar();
 
-  // Prohibit moving and copying
+  // Prohibit copying, as grammars can be large, but allow moving so they can
+  // be returned from functions building them.
   Grammar(Grammar const & other) = delete;
-  Grammar(Grammar && other) = delete;
+  Grammar(Grammar && other) = default;
   Grammar & operator=(Grammar const & other) = delete;
-  Grammar & operator=(Grammar && other) = delete;
+  Grammar & operator=(Grammar && other) = default;
 
   void set_alternatives(
     Symbol const & head,
-    Symbol_String_Alternatives const & alternatives);
-  Symbol_String_Alternatives operator[](Symbol const & symbol) const;
+    Symbol_String_Alternatives alternatives);
+  Symbol_String_Alternatives const & operator[](Symbol const & symbol) const;
+
+  /**
+   * Chooses how FIRST and FOLLOW are computed, discarding any results so far.
+   * `thread_count` applies to the bit matrix backend; 0 uses one per core.
+   * `update_alternatives` always updates with the worklist algorithms.
+   */
+  void set_analysis_backend(Analysis_Backend backend, size_t thread_count = 1);
+
+  /**
+   * Removes the unproductive and unreachable nonterminals, and every
+   * production using them, so that analysis and tables cover only what can
+   * take part in a parse.  Returns what was removed.
+   */
+  Reduction_Report reduce();
+
+  /**
+   * Replaces the alternatives of `head` like `set_alternatives`, but keeps the
+   * analyses, recomputing only the parts which depend on `head`.  Returns the
+   * nonterminals whose predictive parsing table rows may have changed, for
+   * `update_predictive_parsing_table`.
+   */
+  Symbol_Set update_alternatives(
+    Symbol const & head,
+    Symbol_String_Alternatives alternatives);
 
   Symbol start_symbol() const { return start_symbol_; }
 
   bool is_empty_body(Symbol_String const & symbol_string) const;
   bool has_empty_production(Symbol const & sym) const;
-  Symbol_Set empty_producing_symbols() const;
+  Symbol_Set const & empty_producing_symbols() const;
 
   bool is_terminal(Symbol const & symbol) const;
 
-  std::map<Symbol, Symbol_Set> first() const;
-  Symbol_Set first(Symbol const & symbol) const;
+  std::map<Symbol, Symbol_Set> const & first() const;
+  Symbol_Set const & first(Symbol const & symbol) const;
   Symbol_Set first(Symbol_String const & symbol_string) const;
 
-  std::map<Symbol, Symbol_Set> follow() const;
-  Symbol_Set follow(Symbol const & symbol) const;
+  std::map<Symbol, Symbol_Set> const & follow() const;
+  Symbol_Set const & follow(Symbol const & symbol) const;
 
   const std::map<Symbol, Symbol_String_Alternatives> & productions() const { return productions_; }
 };
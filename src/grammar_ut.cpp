@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <random>
+#include <string>
 #include <utility>
 
 #include "grammar.hpp"
@@ -27,6 +29,44 @@ TEST(Grammar_Test, Add_Multiple_Alternative_Production) {
   EXPECT_EQ("A"_sym, grammar.start_symbol());
 }
 
+TEST(Grammar_Test, Alternatives_By_Reference) {
+  Grammar grammar;
+  grammar.set_alternatives("A"_sym, {"B"_sym + "C"_sym | "D"_sym});
+  EXPECT_EQ(&grammar["A"_sym], &grammar.productions().at("A"_sym));
+  EXPECT_TRUE(grammar["Z"_sym].empty());
+  EXPECT_EQ(&grammar.first("A"_sym), &grammar.first().at("A"_sym));
+  EXPECT_EQ(&grammar.follow("A"_sym), &grammar.follow().at("A"_sym));
+  EXPECT_TRUE(grammar.follow("Z"_sym).empty());
+}
+
+namespace {
+
+Grammar
+make_list_grammar()
+{
+  Grammar grammar;
+  grammar.set_alternatives("L"_sym, {"x"_sym + "L'"_sym});
+  grammar.set_alternatives("L'"_sym, {","_sym + "x"_sym + "L'"_sym | Symbol::empty()});
+  return grammar;
+}
+
+} // namespace
+
+TEST(Grammar_Test, Move) {
+  auto grammar = make_list_grammar();
+  EXPECT_EQ("L"_sym, grammar.start_symbol());
+  EXPECT_EQ(grammar.follow("L'"_sym), Symbol_Set({Symbol::right_end_marker()}));
+
+  // Analyses move along with the productions.
+  auto const * first = &grammar.first("L'"_sym);
+  Grammar moved(std::move(grammar));
+  EXPECT_EQ(first, &moved.first("L'"_sym));
+  EXPECT_EQ(*first, Symbol_Set({","_sym, Symbol::empty()}));
+
+  grammar = std::move(moved);
+  EXPECT_EQ(", x L' | empty", as_string(grammar["L'"_sym]));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Start symbol tests
 ////////////////////////////////////////////////////////////////////////////////
@@ -147,6 +187,17 @@ TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, First_String_Test) {
 }
 
 
+TEST(First_Tests, Empty_Only_From_Empty_Producing_Symbols) {
+  // A can produce empty, but S cannot, since b must follow.
+  Grammar grammar;
+  grammar.set_alternatives("S"_sym, {"A"_sym + "b"_sym});
+  grammar.set_alternatives("A"_sym, {"a"_sym | Symbol::empty()});
+  EXPECT_EQ(grammar.first("A"_sym), Symbol_Set({"a"_sym, Symbol::empty()}));
+  EXPECT_EQ(grammar.first("S"_sym), Symbol_Set({"a"_sym, "b"_sym}));
+  EXPECT_EQ(grammar.follow("A"_sym), Symbol_Set({"b"_sym}));
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // FOLLOW(A) Tests
 ////////////////////////////////////////////////////////////////////////////////
@@ -169,6 +220,199 @@ TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, Follow_Test) {
 }
 
 
+TEST(Analysis_Tests, Changing_Alternatives_Discards_Results) {
+  Grammar grammar;
+  grammar.set_alternatives("S"_sym, {"A"_sym + "b"_sym});
+  grammar.set_alternatives("A"_sym, {"a"_sym});
+  EXPECT_FALSE(grammar.has_empty_production("A"_sym));
+  EXPECT_EQ(grammar.first("S"_sym), Symbol_Set({"a"_sym}));
+  EXPECT_EQ(grammar.follow("A"_sym), Symbol_Set({"b"_sym}));
+
+  grammar.set_alternatives("A"_sym, {"c"_sym | Symbol::empty()});
+  EXPECT_TRUE(grammar.has_empty_production("A"_sym));
+  EXPECT_EQ(grammar.first("S"_sym), Symbol_Set({"c"_sym, "b"_sym}));
+  EXPECT_EQ(grammar.first("A"_sym + "A"_sym), Symbol_Set({"c"_sym, Symbol::empty()}));
+
+  grammar.set_alternatives("S"_sym, {"A"_sym + "d"_sym});
+  EXPECT_EQ(grammar.follow("A"_sym), Symbol_Set({"d"_sym}));
+  EXPECT_EQ(grammar.first().at("S"_sym), Symbol_Set({"c"_sym, "d"_sym}));
+}
+
+TEST(Analysis_Tests, Long_Chain) {
+  // A0 -> A1 a0 | empty, A1 -> A2 a1 | empty, ..., with A(n-1) -> An and
+  // An -> b, so every Ai produces empty except An.
+  size_t const length = 200;
+  auto const nonterminal = [](size_t i) { return Symbol("A" + std::to_string(i)); };
+  auto const terminal = [](size_t i) { return Symbol("a" + std::to_string(i)); };
+
+  Grammar grammar;
+  for (size_t i = 0; i + 1 < length; ++i) {
+    grammar.set_alternatives(nonterminal(i), {nonterminal(i + 1) + terminal(i) | Symbol::empty()});
+  }
+  grammar.set_alternatives(nonterminal(length - 1), {nonterminal(length)});
+  grammar.set_alternatives(nonterminal(length), {"b"_sym});
+
+  EXPECT_TRUE(grammar.has_empty_production(nonterminal(0)));
+  EXPECT_FALSE(grammar.has_empty_production(nonterminal(length - 1)));
+
+  // a(n-2) follows A(n-1), which cannot be empty, so cannot start A0.
+  Symbol_Set expected_first = {"b"_sym, Symbol::empty()};
+  for (size_t i = 0; i + 2 < length; ++i) {
+    expected_first.insert(terminal(i));
+  }
+  EXPECT_EQ(expected_first, grammar.first(nonterminal(0)));
+  EXPECT_EQ(Symbol_Set({"b"_sym}), grammar.first(nonterminal(length)));
+
+  // Each Ai is followed by a(i-1), and FOLLOW(A(i-1)) as well since a(i-1)
+  // cannot be empty, so only its own terminal.
+  EXPECT_EQ(Symbol_Set({Symbol::right_end_marker()}), grammar.follow(nonterminal(0)));
+  EXPECT_EQ(Symbol_Set({terminal(length - 2)}), grammar.follow(nonterminal(length - 1)));
+  EXPECT_EQ(Symbol_Set({terminal(length - 2)}), grammar.follow(nonterminal(length)));
+}
+
+TEST(Analysis_Tests, Updates_Match_Full_Analysis) {
+  std::mt19937 random(17);
+  auto const nonterminal = [](size_t i) { return Symbol("U" + std::to_string(i)); };
+  auto const random_alternatives = [&](size_t nonterminals) {
+    Symbol_String_Alternatives alternatives(1 + random() % 3);
+    for (auto & body : alternatives) {
+      auto const length = random() % 4;
+      for (size_t i = 0; i < length; ++i) {
+        if (random() % 2 == 0) {
+          body.push_back(nonterminal(random() % nonterminals));
+        }
+        else {
+          body.push_back(Symbol("u" + std::to_string(random() % 4)));
+        }
+      }
+      if (body.empty()) {
+        body.push_back(Symbol::empty());
+      }
+    }
+    return alternatives;
+  };
+
+  for (size_t trial = 0; trial < 100; ++trial) {
+    size_t const nonterminals = 2 + trial % 6;
+    Grammar grammar;
+    vector<Symbol> order;
+    for (size_t i = 0; i < nonterminals; ++i) {
+      grammar.set_alternatives(nonterminal(i), random_alternatives(nonterminals + 1));
+      order.push_back(nonterminal(i));
+    }
+    grammar.follow();
+
+    for (size_t update = 0; update < 10; ++update) {
+      // May add a new nonterminal, one past the last.
+      auto const head = nonterminal(random() % (nonterminals + 1));
+      if (grammar.is_terminal(head)) {
+        order.push_back(head);
+      }
+      grammar.update_alternatives(head, random_alternatives(nonterminals + 1));
+
+      Grammar fresh;
+      for (auto const & each : order) {
+        fresh.set_alternatives(each, grammar[each]);
+      }
+      ASSERT_EQ(fresh.empty_producing_symbols(), grammar.empty_producing_symbols());
+      ASSERT_EQ(fresh.first(), grammar.first());
+      ASSERT_EQ(fresh.follow(), grammar.follow());
+    }
+  }
+}
+
+TEST(Analysis_Tests, Bit_Matrix_Backend_Matches_Worklist) {
+  std::mt19937 random(23);
+  for (size_t nonterminals : {1, 5, 40, 300}) {
+    for (size_t trial = 0; trial < 10; ++trial) {
+      Grammar worklist;
+      Grammar bit_matrix;
+      bit_matrix.set_analysis_backend(Analysis_Backend::bit_matrix, trial % 3);
+      for (size_t head = 0; head < nonterminals; ++head) {
+        Symbol_String_Alternatives alternatives(1 + random() % 3);
+        for (auto & body : alternatives) {
+          auto const length = random() % 4;
+          for (size_t i = 0; i < length; ++i) {
+            if (random() % 2 == 0) {
+              body.push_back(Symbol("M" + std::to_string(random() % nonterminals)));
+            }
+            else {
+              body.push_back(Symbol("m" + std::to_string(random() % 10)));
+            }
+          }
+          if (body.empty()) {
+            body.push_back(Symbol::empty());
+          }
+        }
+        worklist.set_alternatives(Symbol("M" + std::to_string(head)), alternatives);
+        bit_matrix.set_alternatives(Symbol("M" + std::to_string(head)), alternatives);
+      }
+      ASSERT_EQ(worklist.first(), bit_matrix.first());
+      ASSERT_EQ(worklist.follow(), bit_matrix.follow());
+    }
+  }
+}
+
+TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, Bit_Matrix_Backend) {
+  grammar.set_analysis_backend(Analysis_Backend::bit_matrix);
+  EXPECT_EQ(grammar.first("T'"_sym), Symbol_Set({"*"_sym, Symbol::empty()}));
+  EXPECT_EQ(grammar.follow("F"_sym),
+    Symbol_Set({"*"_sym, "+"_sym, ")"_sym, Symbol::right_end_marker()}));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reduction Tests
+////////////////////////////////////////////////////////////////////////////////
+TEST(Reduction_Tests, Removes_Unproductive_Then_Unreachable) {
+  Grammar grammar;
+  grammar.set_alternatives("S"_sym, {"A"_sym + "B"_sym | "a"_sym | "C"_sym});
+  grammar.set_alternatives("A"_sym, {"a"_sym});
+  grammar.set_alternatives("B"_sym, {"B"_sym + "b"_sym});
+  grammar.set_alternatives("C"_sym, {"c"_sym + "D"_sym | Symbol::empty()});
+  grammar.set_alternatives("D"_sym, {"E"_sym});
+  grammar.set_alternatives("E"_sym, {"D"_sym});
+  grammar.set_alternatives("F"_sym, {"f"_sym});
+  EXPECT_TRUE(grammar.follow("A"_sym).empty());
+
+  auto const report = grammar.reduce();
+  EXPECT_EQ(Symbol_Set({"B"_sym, "D"_sym, "E"_sym}), report.unproductive);
+  // A is only reachable through the production using B.
+  EXPECT_EQ(Symbol_Set({"A"_sym, "F"_sym}), report.unreachable);
+  vector<Production> const removed = {
+    Production("S"_sym, {"A"_sym + "B"_sym}),
+    Production("B"_sym, {"B"_sym + "b"_sym}),
+    Production("C"_sym, {"c"_sym + "D"_sym}),
+    Production("D"_sym, {"E"_sym}),
+    Production("E"_sym, {"D"_sym}),
+    Production("A"_sym, {"a"_sym}),
+    Production("F"_sym, {"f"_sym}),
+  };
+  EXPECT_EQ(removed.size(), report.removed_productions.size());
+  EXPECT_TRUE(std::is_permutation(removed.begin(), removed.end(), report.removed_productions.begin()));
+
+  EXPECT_EQ("a | C", as_string(grammar["S"_sym]));
+  EXPECT_EQ("empty", as_string(grammar["C"_sym]));
+  EXPECT_EQ(2u, grammar.productions().size());
+  EXPECT_TRUE(grammar.is_terminal("A"_sym));
+  EXPECT_EQ(grammar.first("S"_sym), Symbol_Set({"a"_sym, Symbol::empty()}));
+  EXPECT_TRUE(grammar.reduce().empty());
+}
+
+TEST(Reduction_Tests, Unproductive_Start_Symbol) {
+  Grammar grammar;
+  grammar.set_alternatives("S"_sym, {"a"_sym + "S"_sym});
+  auto const report = grammar.reduce();
+  EXPECT_EQ(Symbol_Set({"S"_sym}), report.unproductive);
+  EXPECT_TRUE(report.unreachable.empty());
+  EXPECT_TRUE(grammar["S"_sym].empty());
+  EXPECT_EQ("S"_sym, grammar.start_symbol());
+}
+
+TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, Reduce_Keeps_Reduced_Grammar) {
+  EXPECT_TRUE(grammar.reduce().empty());
+  EXPECT_EQ(5u, grammar.productions().size());
+}
+
 int main(int argc, char ** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
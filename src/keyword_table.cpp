@@ -0,0 +1,201 @@
+#include "keyword_table.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace parka {
+
+constexpr std::uint32_t Keyword_Table::empty_slot;
+
+namespace {
+
+/// Seeds tried for a bucket before giving up on a table size.
+constexpr std::uint32_t max_bucket_seed = 1u << 16;
+
+
+bool
+is_word_char(char_type ch)
+{
+  auto const byte = static_cast<unsigned char>(ch);
+  return (byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z') || (byte >= '0' && byte <= '9') || byte == '_';
+}
+
+
+/**
+ * Finalizer of MurmurHash3, so that nearby inputs give unrelated outputs.
+ */
+std::uint64_t
+mix(std::uint64_t value)
+{
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdull;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ull;
+  value ^= value >> 33;
+  return value;
+}
+
+
+size_t
+bucket_of(std::uint64_t hash, size_t bucket_count)
+{
+  return static_cast<size_t>(hash % bucket_count);
+}
+
+
+size_t
+slot_of(std::uint64_t hash, std::uint32_t seed, size_t slot_mask)
+{
+  return static_cast<size_t>(mix(hash + seed * 0x9e3779b97f4a7c15ull)) & slot_mask;
+}
+
+} // namespace
+
+
+bool
+Keyword_Table::accepts(string const & word)
+{
+  return !word.empty() && std::all_of(word.begin(), word.end(), is_word_char);
+}
+
+
+void
+Keyword_Table::add(string const & word, size_t priority, Symbol const & symbol)
+{
+  auto const exists = std::any_of(keywords_.begin(), keywords_.end(), [&](Keyword const & keyword) {
+    return keyword.word == word;
+  });
+  if (!exists) {
+    keywords_.push_back({word, priority, symbol});
+  }
+  slots_.clear();
+}
+
+
+/**
+ * Chooses seeds so that no two keywords share a slot.  Larger tables are
+ * tried if the seeds run out, and then different hash functions, which is
+ * only needed if two keywords hash identically.
+ */
+void
+Keyword_Table::build()
+{
+  min_length_ = keywords_.empty() ? 0 : static_cast<size_t>(-1);
+  max_length_ = 0;
+  for (auto const & keyword : keywords_) {
+    min_length_ = std::min(min_length_, keyword.word.size());
+    max_length_ = std::max(max_length_, keyword.word.size());
+  }
+
+  size_t slot_count = 1;
+  while (slot_count < keywords_.size()) {
+    slot_count *= 2;
+  }
+
+  for (hash_seed_ = 0; ; ++hash_seed_) {
+    for (auto slots = slot_count; slots <= slot_count * 8; slots *= 2) {
+      if (place(slots)) {
+        return;
+      }
+    }
+  }
+}
+
+
+bool
+Keyword_Table::place(size_t slot_count)
+{
+  slot_mask_ = slot_count - 1;
+  slots_.assign(slot_count, empty_slot);
+  bucket_seeds_.assign(std::max<size_t>(1, keywords_.size() / 2), 0);
+
+  std::vector<std::uint64_t> hashes;
+  std::vector<std::vector<std::uint32_t>> buckets(bucket_seeds_.size());
+  for (size_t i = 0; i < keywords_.size(); ++i) {
+    auto const & word = keywords_[i].word;
+    hashes.push_back(hash(word.data(), word.size()));
+    buckets[bucket_of(hashes.back(), buckets.size())].push_back(static_cast<std::uint32_t>(i));
+  }
+
+  // Fitting the largest buckets first, while most slots are free, makes it
+  // much more likely a seed is found for each.
+  std::vector<size_t> order(buckets.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return buckets[lhs].size() > buckets[rhs].size();
+  });
+
+  std::vector<size_t> taken;
+  for (auto const bucket : order) {
+    if (buckets[bucket].empty()) {
+      break;
+    }
+    std::uint32_t seed = 0;
+    for (; seed < max_bucket_seed; ++seed) {
+      taken.clear();
+      auto fits = true;
+      for (auto const keyword : buckets[bucket]) {
+        auto const slot = slot_of(hashes[keyword], seed, slot_mask_);
+        if (slots_[slot] != empty_slot || std::find(taken.begin(), taken.end(), slot) != taken.end()) {
+          fits = false;
+          break;
+        }
+        taken.push_back(slot);
+      }
+      if (fits) {
+        break;
+      }
+    }
+    if (seed == max_bucket_seed) {
+      slots_.clear();
+      return false;
+    }
+    bucket_seeds_[bucket] = seed;
+    for (size_t i = 0; i < taken.size(); ++i) {
+      slots_[taken[i]] = buckets[bucket][i];
+    }
+  }
+  return true;
+}
+
+
+/**
+ * Finds the keyword which is exactly the given word, or returns null.
+ */
+Keyword_Table::Keyword const *
+Keyword_Table::find(char_type const * word, size_t length) const
+{
+  if (slots_.empty() || length < min_length_ || length > max_length_) {
+    return nullptr;
+  }
+  auto const word_hash = hash(word, length);
+  auto const seed = bucket_seeds_[bucket_of(word_hash, bucket_seeds_.size())];
+  auto const index = slots_[slot_of(word_hash, seed, slot_mask_)];
+  if (index == empty_slot) {
+    return nullptr;
+  }
+  auto const & keyword = keywords_[index];
+  if (keyword.word.size() != length || std::memcmp(keyword.word.data(), word, length) != 0) {
+    return nullptr;
+  }
+  return &keyword;
+}
+
+
+/**
+ * FNV-1a over the word, starting from the table's hash seed.
+ */
+std::uint64_t
+Keyword_Table::hash(char_type const * word, size_t length) const
+{
+  std::uint64_t result = 0xcbf29ce484222325ull ^ mix(hash_seed_);
+  for (size_t i = 0; i < length; ++i) {
+    result ^= static_cast<unsigned char>(word[i]);
+    result *= 0x100000001b3ull;
+  }
+  return mix(result);
+}
+
+} // namespace parka
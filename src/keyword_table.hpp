@@ -0,0 +1,71 @@
+#pragma once
+
+#include "string.hpp"
+#include "symbol.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace parka {
+
+/**
+ * Keywords made of word characters (`[A-Za-z0-9_]`), looked up by the whole
+ * word at the current input position.  This replaces a `\bkeyword\b` pattern
+ * per keyword: a lexer finds the word once and asks the table, at a cost
+ * depending only on the word's length, not on the number of keywords.
+ *
+ * The table is a two level perfect hash ("hash and displace").  The first
+ * hash picks a bucket, and each bucket has a seed chosen by `build` so the
+ * second hash sends every keyword to its own slot.  A lookup then hashes the
+ * word once and compares it against a single candidate.
+ */
+class Keyword_Table {
+public:
+  struct Keyword {
+    string word;
+
+    /// Number of patterns registered before the keyword, which it beats.
+    size_t priority;
+
+    Symbol symbol;
+  };
+
+  /**
+   * Whether a keyword can be looked up in the table, rather than needing a
+   * pattern.
+   */
+  static bool accepts(string const & word);
+
+  /**
+   * Adds a keyword, unless it was already added.  The table must be built
+   * again before looking up any words.
+   */
+  void add(string const & word, size_t priority, Symbol const & symbol);
+  void build();
+  bool is_built() const { return !slots_.empty(); }
+
+  Keyword const * find(char_type const * word, size_t length) const;
+
+  bool empty() const { return keywords_.empty(); }
+  size_t size() const { return keywords_.size(); }
+
+private:
+  static constexpr std::uint32_t empty_slot = static_cast<std::uint32_t>(-1);
+
+  std::vector<Keyword> keywords_;
+
+  std::uint64_t hash_seed_ = 0;
+  std::vector<std::uint32_t> bucket_seeds_;
+  size_t slot_mask_ = 0;
+
+  // Index into keywords_ for each slot, or empty_slot.
+  std::vector<std::uint32_t> slots_;
+
+  size_t min_length_ = 0;
+  size_t max_length_ = 0;
+
+  std::uint64_t hash(char_type const * word, size_t length) const;
+  bool place(size_t slot_count);
+};
+
+} // namespace parka
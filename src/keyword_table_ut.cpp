@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include "keyword_table.hpp"
+#include "string.hpp"
+#include "symbol.hpp"
+using namespace parka;
+
+
+namespace {
+
+Keyword_Table::Keyword const *
+find(Keyword_Table const & table, string const & word)
+{
+  return table.find(word.data(), word.size());
+}
+
+} // namespace
+
+
+TEST(Keyword_Table_Test, Accepts_Word_Characters_Only) {
+  EXPECT_TRUE(Keyword_Table::accepts("for"));
+  EXPECT_TRUE(Keyword_Table::accepts("__init__"));
+  EXPECT_TRUE(Keyword_Table::accepts("int32"));
+  EXPECT_FALSE(Keyword_Table::accepts(""));
+  EXPECT_FALSE(Keyword_Table::accepts("+="));
+  EXPECT_FALSE(Keyword_Table::accepts("co-op"));
+}
+
+
+TEST(Keyword_Table_Test, Finds_Whole_Words) {
+  Keyword_Table table;
+  table.add("for", 0, Symbol("for"));
+  table.add("foreach", 1, Symbol("foreach"));
+  table.add("in", 2, Symbol("in"));
+  table.add("for", 3, Symbol("duplicate"));
+  table.build();
+  ASSERT_TRUE(table.is_built());
+  EXPECT_EQ(3u, table.size());
+
+  auto const keyword = find(table, "for");
+  ASSERT_NE(nullptr, keyword);
+  EXPECT_EQ(0u, keyword->priority);
+  EXPECT_EQ(Symbol("for"), keyword->symbol);
+  ASSERT_NE(nullptr, find(table, "foreach"));
+  ASSERT_NE(nullptr, find(table, "in"));
+
+  EXPECT_EQ(nullptr, find(table, "fo"));
+  EXPECT_EQ(nullptr, find(table, "fore"));
+  EXPECT_EQ(nullptr, find(table, "inn"));
+  EXPECT_EQ(nullptr, find(table, ""));
+}
+
+
+TEST(Keyword_Table_Test, Many_Keywords) {
+  Keyword_Table table;
+  std::vector<string> words;
+  for (size_t i = 0; i < 1000; ++i) {
+    words.push_back("keyword_" + std::to_string(i));
+    table.add(words.back(), i, Symbol(words.back()));
+  }
+  table.build();
+
+  for (size_t i = 0; i < words.size(); ++i) {
+    auto const keyword = find(table, words[i]);
+    ASSERT_NE(nullptr, keyword) << words[i];
+    EXPECT_EQ(i, keyword->priority);
+    EXPECT_EQ(nullptr, find(table, words[i] + "x"));
+  }
+  EXPECT_EQ(nullptr, find(table, "keyword_1000"));
+}
+
+
+TEST(Keyword_Table_Test, Empty) {
+  Keyword_Table table;
+  table.build();
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(nullptr, find(table, "for"));
+}
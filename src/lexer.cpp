@@ -3,12 +3,32 @@
 #include "streams.hpp"
 #include "string.hpp"
 
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
 
 namespace parka {
 
 Lexer::Lexer()
-  : ignore_characters_(" \t\r\n")
+  : ignored_()
+  , ignored_ranges_usable_(false)
+  , has_next_(false)
+  , backend_(Lexer_Backend::automatic)
+  , scanner_supports_patterns_(true)
+  , scanner_is_compiled_(false)
 {
+  Byte_Set ignored;
+  for (auto const ch : string(" \t\r\n")) {
+    ignored_[static_cast<unsigned char>(ch)] = true;
+    ignored.set(static_cast<unsigned char>(ch));
+  }
+  ignored_ranges_usable_ = Byte_Ranges::from_set(ignored, &ignored_ranges_);
+
+  Byte_Set word;
+  for (size_t byte = 0; byte < word.size(); ++byte) {
+    word[byte] = Keyword_Table::accepts(string(1, static_cast<char_type>(byte)));
+  }
+  Byte_Ranges::from_set(word, &word_ranges_);
 }
 
 /**
@@ -23,7 +43,7 @@ Lexer::register_pattern_for_token(
   string const & pattern,
   string const & token)
 {
-  token_patterns_.push_back(std::make_pair(std::regex(pattern), Symbol {token}));
+  add_pattern(std::regex(pattern), pattern, token);
 }
 
 
@@ -33,85 +53,840 @@ Lexer::register_pattern_for_token(
 void
 Lexer::register_keyword(string const & keyword)
 {
-  token_patterns_.push_back(std::make_pair(std::regex("\\b" + keyword + "\\b"), Symbol {keyword}));
+  if (Keyword_Table::accepts(keyword)) {
+    keywords_.add(keyword, token_patterns_.size(), Symbol {keyword});
+    return;
+  }
+  auto const pattern = "\\b" + keyword + "\\b";
+  add_pattern(std::regex(pattern), pattern, keyword);
+}
+
+
+void
+Lexer::add_pattern(
+  regex const & expression,
+  string const & pattern,
+  string const & token)
+{
+  auto const index = token_patterns_.size();
+  token_patterns_.push_back(std::make_pair(expression, Symbol {token}));
+
+  // The scanner's pattern indices must line up with token_patterns_, so once
+  // one is rejected, it is of no further use.
+  Pattern parsed;
+  auto const is_supported = parse_pattern(pattern, &parsed);
+  if (scanner_supports_patterns_ && is_supported) {
+    scanner_.add_pattern(parsed);
+  }
+  scanner_supports_patterns_ = scanner_supports_patterns_ && is_supported;
+  scanner_is_compiled_ = false;
+
+  // Without knowing what a pattern can start with, it has to be tried
+  // everywhere.
+  Byte_Set starts;
+  if (is_supported) {
+    starts = first_bytes(parsed);
+  }
+  else {
+    starts.set();
+  }
+  for (size_t byte = 0; byte < starts.size(); ++byte) {
+    if (starts.test(byte)) {
+      patterns_by_first_byte_[byte].push_back(index);
+    }
+  }
+}
+
+
+/**
+ * Compiles the scanner if patterns have been added since it was last used.
+ */
+void
+Lexer::compile_patterns()
+{
+  if (scanner_supports_patterns_ && !scanner_is_compiled_) {
+    scanner_supports_patterns_ = scanner_.compile();
+    scanner_is_compiled_ = true;
+  }
+  if (!keywords_.is_built()) {
+    keywords_.build();
+  }
+}
+
+
+bool
+Lexer::scanner_is_usable() const
+{
+  return backend_ == Lexer_Backend::automatic && scanner_supports_patterns_ && scanner_is_compiled_;
+}
+
+
+char_type const *
+Lexer::skip_ignored(char_type const * current, char_type const * end) const
+{
+  if (ignored_ranges_usable_) {
+    return find_run_end(current, end, ignored_ranges_);
+  }
+  while (current != end && is_ignored(*current)) {
+    ++current;
+  }
+  return current;
+}
+
+
+/**
+ * Finds the first pattern or keyword matching at `current`.  If `end` is not
+ * the end of the input, the result may depend on what follows, which is
+ * reported by `Match::needs_input`.
+ */
+Lexer::Match
+Lexer::match(
+  char_type const * current,
+  char_type const * end,
+  bool at_end_of_input) const
+{
+  auto const remaining = static_cast<size_t>(end - current);
+  auto pattern = Scanner::no_match;
+  size_t length = 0;
+
+  // Without the scanner, how far std::regex looked is unknown, so the result
+  // is taken to depend on everything up to the end.
+  auto examined = remaining + 1;
+
+  if (scanner_is_usable()) {
+    auto const found = scanner_.match(current, end);
+    pattern = found.pattern;
+    length = found.length;
+    examined = found.examined;
+  }
+  else {
+    // Only accept non-empty matches which begin at the current position.
+    auto const flags = std::regex_constants::match_continuous | std::regex_constants::match_not_null;
+
+    for (auto const index : patterns_by_first_byte_[static_cast<unsigned char>(*current)]) {
+      std::match_results<char_type const *> found;
+      if (std::regex_search(current, end, found, token_patterns_[index].first, flags)) {
+        pattern = index;
+        length = static_cast<size_t>(found.length(0));
+        break;
+      }
+    }
+  }
+  auto needs_input = !at_end_of_input && (scanner_is_usable() ? examined > remaining : length == remaining);
+
+  // A keyword matches only the whole word, which is not known until the word
+  // ends.
+  if (!keywords_.empty() && word_ranges_.contains(*current)) {
+    auto const word_end = find_run_end(current, end, word_ranges_);
+    auto const word_length = static_cast<size_t>(word_end - current);
+    examined = std::max(examined, word_length + 1);
+    if (word_end == end && !at_end_of_input) {
+      return {nullptr, 0, examined, true};
+    }
+    auto const keyword = keywords_.find(current, word_length);
+    if (keyword != nullptr && keyword->priority <= pattern) {
+      return {&keyword->symbol, word_length, examined, false};
+    }
+  }
+
+  if (pattern == Scanner::no_match) {
+    return {nullptr, 0, examined, needs_input};
+  }
+  return {&token_patterns_[pattern].second, length, examined, needs_input};
+}
+
+
+/**
+ * Releases previous inputs once all their tokens have been taken.
+ */
+void
+Lexer::release_sources()
+{
+  if (inputs_.empty() && !has_next_) {
+    sources_.clear();
+    mapped_files_.clear();
+  }
+}
+
+
+/**
+ * Creates a buffer to hold a new input.
+ */
+string &
+Lexer::new_source()
+{
+  release_sources();
+  sources_.emplace_back();
+  return sources_.back();
 }
 
 
 void
 Lexer::lex(string const & str)
 {
-  stringstream ss(str);
-  lex(ss);
+  // Terminated by a newline like input read from a stream.
+  auto & buffer = new_source();
+  buffer.reserve(str.size() + 1);
+  buffer.append(str);
+  buffer.append("\n");
+  inputs_.emplace_back(buffer.data(), buffer.data() + buffer.size());
 }
 
 
 void
 Lexer::lex(istream & input)
 {
-  // Builds a buffer of all our input.
-  // TODO: Only buffer a certain amount at a time (e.g. 16K)
-  // TODO: Very inefficient, but will work.
-  string buffer;
-  while (input) {
-    string next_line;
-    std::getline(input, next_line);
-    buffer.append(next_line);
-    buffer.append("\n");
+  // Builds a buffer of all our input, terminated by a newline as if it had
+  // been read line by line.
+  auto & buffer = new_source();
+  char_type chunk[Stream_Lexer::default_window_size];
+  while (input.read(chunk, Stream_Lexer::default_window_size) || input.gcount() > 0) {
+    buffer.append(chunk, static_cast<size_t>(input.gcount()));
   }
+  buffer.append("\n");
+  inputs_.emplace_back(buffer.data(), buffer.data() + buffer.size());
+}
+
 
-  // Find the first matching pattern at the current input.
-  auto current = buffer.cbegin();
-  auto eof = buffer.cend();
+/**
+ * Lexes input which is not copied, so must stay unchanged until all of its
+ * tokens have been used.  Unlike the other forms of `lex`, the input is lexed
+ * exactly as given, without an implied newline at the end.
+ */
+void
+Lexer::lex_borrowed(char_type const * data, size_t size)
+{
+  release_sources();
+  inputs_.emplace_back(data, data + size);
+}
+
+
+/**
+ * Lexes a file by mapping it into memory, rather than reading it, so its
+ * contents are never copied and tokens refer straight to the mapped file.  The
+ * mapping is kept until the next call to `lex` after all of its tokens have
+ * been taken.
+ *
+ * Like `lex_borrowed`, the file is lexed exactly as is, with no implied
+ * newline at the end.  Throws `std::system_error` if the file cannot be read.
+ */
+void
+Lexer::lex_file(string const & path)
+{
+  Mapped_File file(path);
+  release_sources();
+  mapped_files_.push_back(std::move(file));
+
+  auto const & mapped = mapped_files_.back();
+  inputs_.emplace_back(mapped.data(), mapped.data() + mapped.size());
+}
+
+
+/**
+ * Lexes the next token from the input between `current` and `end`, advancing
+ * `current` past it.  Returns false if there are no more tokens.
+ *
+ * If `examined` is given, it is set to the number of characters from the
+ * original `current` which the result depends on, as for `Scanner::Match`.
+ */
+bool
+Lexer::lex_next(
+  char_type const ** current,
+  char_type const * end,
+  Token_View * token,
+  size_t * examined) const
+{
+  auto position = *current;
+  if (examined != nullptr) {
+    *examined = 0;
+  }
 
   // Continue until end of buffer reached.
-  while (current != eof) {
+  while (position != end) {
     // Finds next whitespace or end of input.
-    while (current != eof && is_ignored(*current)) {
-      ++current;
+    position = skip_ignored(position, end);
+    if (position == end) {
+      break;
     }
 
-    if (current == eof) {
-      return;
+    auto const found = match(position, end, true);
+    if (found.symbol != nullptr) {
+      if (examined != nullptr) {
+        *examined = std::max(*examined, static_cast<size_t>(position - *current) + found.examined);
+      }
+      *token = Token_View(*found.symbol, Lexeme_View(position, found.length));
+      *current = position + found.length;
+      return true;
+    }
+    if (examined != nullptr) {
+      *examined = std::max(*examined, static_cast<size_t>(position - *current) + found.examined);
+    }
+
+    // No match found, move to the next character.
+    // TODO: Report an error.
+    ++position;
+  }
+  if (examined != nullptr) {
+    *examined = static_cast<size_t>(end - *current) + 1;
+  }
+  *current = end;
+  return false;
+}
+
+
+/**
+ * Lexes all of a string on several threads, giving the same tokens as `lex`
+ * would, including the implied newline at the end.  The tokens refer to the
+ * lexer's copy of the string, so stay valid until the next call to `lex`.
+ *
+ * Inputs given to the other forms of `lex` are unaffected, and continue to be
+ * lexed on demand.
+ */
+std::vector<Token_View>
+Lexer::lex_parallel(string const & str, Parallel_Lex_Options const & options)
+{
+  auto & buffer = new_source();
+  buffer.reserve(str.size() + 1);
+  buffer.append(str);
+  buffer.append("\n");
+  return lex_parallel(buffer.data(), buffer.size(), options);
+}
+
+
+/**
+ * Lexes all of an input on several threads, giving the same tokens as
+ * `lex_borrowed` would.  The input is not copied, so tokens refer to it
+ * directly.
+ *
+ * The input is split into a chunk per thread, each starting just after a
+ * `split_after` character.  The threads lex their chunks, and share nothing
+ * but the compiled patterns.  A token may continue across a split (a string
+ * or comment spanning lines), so each chunk is only a guess at where lexing
+ * would be.  Before joining the chunks, the tokens leading up to each one are
+ * checked to end at a position its own lexing passed through.  Because the
+ * lexer holds no state beyond its position, the chunk's tokens from there on
+ * are then exactly those lexing straight through would give.  Otherwise,
+ * tokens are lexed one at a time from where the previous chunk ended until
+ * they meet one of its positions.
+ */
+std::vector<Token_View>
+Lexer::lex_parallel(
+  char_type const * data,
+  size_t size,
+  Parallel_Lex_Options const & options)
+{
+  compile_patterns();
+
+  auto const end = data + size;
+  auto thread_count = options.thread_count != 0 ? options.thread_count : std::thread::hardware_concurrency();
+  thread_count = std::max<size_t>(1, std::min(thread_count, size / std::max<size_t>(1, options.min_chunk_size)));
+
+  // Chunk starts, from which the last chunk runs to the end of the input.
+  std::vector<char_type const *> starts {data};
+  for (size_t i = 1; i < thread_count; ++i) {
+    auto split = std::max(data + size / thread_count * i, starts.back());
+    split = std::find(split, end, options.split_after);
+    if (split == end) {
+      break;
     }
+    starts.push_back(split + 1);
+  }
+  auto const chunk_count = starts.size();
+  starts.push_back(end);
 
-    auto found_match = false;
-    for (auto regex_token_pair : token_patterns_) {
-      std::smatch match;
+  std::vector<std::vector<Token_View>> tokens(chunk_count);
+  std::vector<std::vector<char_type const *>> positions(chunk_count);
+  {
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < chunk_count; ++i) {
+      workers.emplace_back([&, i]() {
+        lex_chunk(starts[i], starts[i + 1], end, &tokens[i], &positions[i]);
+      });
+    }
+    lex_chunk(starts[0], starts[1], end, &tokens[0], &positions[0]);
+    for (auto & worker : workers) {
+      worker.join();
+    }
+  }
 
-      // Verify starting at current position.
-      if (std::regex_search(current, eof, match, regex_token_pair.first)
-          && match[0].first == current)
-      {
-        tokens_.push_back({regex_token_pair.second, match.str()});
-        current = match[0].second;
-        found_match = true;
+  auto result = std::move(tokens[0]);
+  auto position = positions[0].back();
+  for (size_t i = 1; i < chunk_count; ++i) {
+    auto const & chunk_positions = positions[i];
+    while (true) {
+      auto const meets = std::lower_bound(chunk_positions.begin(), chunk_positions.end(), position);
+      if (meets == chunk_positions.end()) {
+        // Lexing has already gone past this chunk.
         break;
       }
+      if (*meets == position) {
+        auto const first = tokens[i].begin() + (meets - chunk_positions.begin());
+        result.insert(result.end(), first, tokens[i].end());
+        position = chunk_positions.back();
+        break;
+      }
+
+      Token_View token;
+      if (!lex_next(&position, end, &token)) {
+        return result;
+      }
+      result.push_back(token);
+      position = skip_ignored(position, end);
     }
+  }
+  return result;
+}
 
-    // No match found, report an error and move to the next character
-    // TODO: Report an error.
-    if (!found_match) {
-      ++current;
+
+/**
+ * Lexes the tokens starting before `stop`, which may continue up to `end`.
+ * Records the position before each token, after any ignored characters, and
+ * the position after the last, so there is one more position than tokens.
+ */
+void
+Lexer::lex_chunk(
+  char_type const * begin,
+  char_type const * stop,
+  char_type const * end,
+  std::vector<Token_View> * tokens,
+  std::vector<char_type const *> * positions) const
+{
+  auto position = skip_ignored(begin, end);
+  positions->push_back(position);
+
+  Token_View token;
+  while (position < stop) {
+    if (!lex_next(&position, end, &token)) {
+      // Nothing but unmatched characters remain, the same as at the end.
+      positions->back() = end;
+      break;
     }
+    tokens->push_back(token);
+    position = skip_ignored(position, end);
+    positions->push_back(position);
   }
 }
 
 
 bool
-Lexer::has_next_token() const
+Lexer::has_next_token()
 {
-  return tokens_.size() != 0;
+  compile_patterns();
+  while (!has_next_ && !inputs_.empty()) {
+    auto & input = inputs_.front();
+    has_next_ = lex_next(&input.first, input.second, &next_);
+    if (!has_next_) {
+      inputs_.pop_front();
+    }
+  }
+  return has_next_;
 }
 
 
 Token
 Lexer::next_token()
 {
-  // FIXME: Throw an exception here if no tokens_ are available.
-  auto tk = tokens_.front();
-  tokens_.pop_front();
-  return tk;
+  return Token(next_token_view());
+}
+
+
+/**
+ * Takes the next token without copying its lexeme.  It remains valid until the
+ * next call to `lex`.
+ */
+Token_View
+Lexer::next_token_view()
+{
+  // FIXME: Throw an exception here if no tokens are available.
+  has_next_token();
+  has_next_ = false;
+  return next_;
+}
+
+
+constexpr size_t Stream_Lexer::default_window_size;
+
+Stream_Lexer::Stream_Lexer(
+  Lexer & lexer,
+  istream & input,
+  size_t window_size)
+  : lexer_(lexer)
+  , input_(input)
+  , window_(std::max<size_t>(window_size, 2))
+  , begin_(0)
+  , end_(0)
+  , at_end_of_input_(false)
+  , has_next_(false)
+{
+  lexer_.compile_patterns();
+}
+
+
+bool
+Stream_Lexer::has_next_token()
+{
+  if (!has_next_) {
+    has_next_ = advance();
+  }
+  return has_next_;
+}
+
+
+Token
+Stream_Lexer::next_token()
+{
+  return Token(next_token_view());
+}
+
+
+Token_View
+Stream_Lexer::next_token_view()
+{
+  // FIXME: Throw an exception here if no tokens are available.
+  has_next_token();
+  has_next_ = false;
+  return next_;
+}
+
+
+/**
+ * Moves the unlexed input to the start of the window and reads as much more as
+ * fits, growing the window if it is already full.  Like Lexer::lex, the input
+ * is terminated with a newline.
+ */
+void
+Stream_Lexer::refill()
+{
+  if (at_end_of_input_) {
+    return;
+  }
+
+  if (begin_ != 0) {
+    std::copy(window_.begin() + begin_, window_.begin() + end_, window_.begin());
+    end_ -= begin_;
+    begin_ = 0;
+  }
+  if (end_ == window_.size()) {
+    window_.resize(window_.size() * 2);
+  }
+
+  input_.read(window_.data() + end_, static_cast<std::streamsize>(window_.size() - end_));
+  end_ += static_cast<size_t>(input_.gcount());
+
+  if (!input_) {
+    at_end_of_input_ = true;
+    if (end_ == window_.size()) {
+      window_.resize(window_.size() + 1);
+    }
+    window_[end_++] = '\n';
+  }
+}
+
+
+/**
+ * Lexes the next token into next_, returning false at the end of input.
+ */
+bool
+Stream_Lexer::advance()
+{
+  while (true) {
+    // Keep at least half a window of input ahead, so only tokens longer than
+    // that need to grow the window.
+    if (!at_end_of_input_ && (end_ - begin_) < window_.size() / 2) {
+      refill();
+    }
+
+    auto const data = window_.data();
+    begin_ = static_cast<size_t>(lexer_.skip_ignored(data + begin_, data + end_) - data);
+    if (begin_ == end_) {
+      if (at_end_of_input_) {
+        return false;
+      }
+      refill();
+      continue;
+    }
+
+    auto const found = lexer_.match(data + begin_, data + end_, at_end_of_input_);
+    if (found.needs_input) {
+      refill();
+      continue;
+    }
+
+    if (found.symbol != nullptr) {
+      next_ = Token_View(*found.symbol, Lexeme_View(data + begin_, found.length));
+      begin_ += found.length;
+      return true;
+    }
+
+    // No match found, move to the next character.
+    // TODO: Report an error.
+    ++begin_;
+  }
+}
+
+Incremental_Lexer::Incremental_Lexer(Lexer & lexer, string text)
+  : lexer_(lexer)
+  , buffer_(text.begin(), text.end())
+  , gap_begin_(buffer_.size())
+  , gap_end_(buffer_.size())
+  , token_gap_begin_(0)
+  , token_gap_end_(0)
+  , end_lookback_(0)
+{
+  lexer_.compile_patterns();
+  edit(0, 0, "");
+}
+
+
+/**
+ * Replaces `removed` characters at `offset` with `inserted`, and lexes the
+ * damaged tokens again.  Throws `std::out_of_range` if the removed characters
+ * are not all within the document.
+ */
+Incremental_Lexer::Relexed
+Incremental_Lexer::edit(size_t offset, size_t removed, string const & inserted)
+{
+  if (offset > size() || removed > size() - offset) {
+    throw std::out_of_range("Incremental_Lexer::edit: edit beyond the end of the document");
+  }
+
+  // Tokens from the first damaged one on are kept relative to the end, so
+  // are already where the edit moves them.
+  auto const first = first_damaged(offset);
+  move_token_gap(first);
+  auto const start = first == 0 ? size_t {0} : token(first - 1).offset + token(first - 1).length;
+
+  move_gap(offset);
+  gap_end_ += removed;
+  if (gap_end_ - gap_begin_ < inserted.size()) {
+    // Grows the gap to at least the size of the document, so growing it again
+    // takes as many characters inserted as it copies.
+    auto const gap_size = std::max(inserted.size(), buffer_.size() - (gap_end_ - gap_begin_));
+    std::vector<char_type> buffer(buffer_.size() - (gap_end_ - gap_begin_) + gap_size);
+    std::copy(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(gap_begin_), buffer.begin());
+    std::copy(buffer_.begin() + static_cast<std::ptrdiff_t>(gap_end_), buffer_.end(), buffer.begin() + static_cast<std::ptrdiff_t>(gap_begin_ + gap_size));
+    gap_end_ = gap_begin_ + gap_size;
+    buffer_.swap(buffer);
+  }
+  std::copy(inserted.begin(), inserted.end(), buffer_.begin() + static_cast<std::ptrdiff_t>(gap_begin_));
+  gap_begin_ += inserted.size();
+
+  // Lexing works on the text after the gap, which runs to the end of the
+  // document.
+  move_gap(start);
+  auto const text_end = buffer_.data() + buffer_.size();
+  auto const new_edit_end = offset + inserted.size();
+
+  Relexed result {first, 0, 0};
+  auto position = start;
+  while (true) {
+    position += static_cast<size_t>(lexer_.skip_ignored(text_at(position), text_end) - text_at(position));
+    if (position >= new_edit_end) {
+      while (token_gap_end_ != entries_.size() && token(token_gap_begin_).offset < position) {
+        ++token_gap_end_;
+        ++result.removed;
+      }
+      if (token_gap_end_ != entries_.size() && token(token_gap_begin_).offset == position) {
+        break;
+      }
+    }
+
+    auto const begin = text_at(position);
+    auto current = begin;
+    Token_View found;
+    size_t examined = 0;
+    if (!lexer_.lex_next(&current, text_end, &found, &examined)) {
+      result.removed += entries_.size() - token_gap_end_;
+      token_gap_end_ = entries_.size();
+      break;
+    }
+    auto const token_offset = position + static_cast<size_t>(found.lexeme.data() - begin);
+    Entry entry {{found.symbol, token_offset, found.lexeme.size(), position + examined}, 0};
+    position = token_offset + found.lexeme.size();
+
+    if (token_gap_begin_ == token_gap_end_) {
+      auto const gap_size = std::max<size_t>(16, entries_.size());
+      entries_.insert(entries_.begin() + static_cast<std::ptrdiff_t>(token_gap_begin_), gap_size, Entry());
+      token_gap_end_ += gap_size;
+    }
+    entries_[token_gap_begin_] = entry;
+    ++token_gap_begin_;
+    ++result.inserted;
+    set_lookback(token_gap_begin_ - 1, find_lookback(token_gap_begin_ - 1));
+  }
+
+  // Tokens kept after the edit may have looked back to replaced tokens, until
+  // one neither did nor does now.
+  auto const kept = token_gap_begin_;
+  for (auto index = kept; index <= token_count(); ++index) {
+    auto const updated = find_lookback(index);
+    if (lookback(index) <= index - kept && updated <= index - kept) {
+      break;
+    }
+    set_lookback(index, updated);
+  }
+  return result;
+}
+
+
+string
+Incremental_Lexer::text() const
+{
+  string result(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(gap_begin_));
+  result.append(buffer_.begin() + static_cast<std::ptrdiff_t>(gap_end_), buffer_.end());
+  return result;
+}
+
+
+Incremental_Lexer::Token
+Incremental_Lexer::token(size_t index) const
+{
+  if (index < token_gap_begin_) {
+    return entries_[index].token;
+  }
+  return flipped(entries_[index + token_gap_end_ - token_gap_begin_].token);
+}
+
+
+Token_View
+Incremental_Lexer::token_view(size_t index) const
+{
+  auto const found = token(index);
+  return Token_View(found.symbol, Lexeme_View(text_at(found.offset), found.length));
+}
+
+
+/**
+ * The character at `offset`, which is followed by the rest of the text before
+ * or after the gap.
+ */
+char_type const *
+Incremental_Lexer::text_at(size_t offset) const
+{
+  return buffer_.data() + (offset < gap_begin_ ? offset : offset + gap_end_ - gap_begin_);
+}
+
+
+void
+Incremental_Lexer::move_gap(size_t offset)
+{
+  auto const data = buffer_.data();
+  if (offset < gap_begin_) {
+    std::copy_backward(data + offset, data + gap_begin_, data + gap_end_);
+    gap_end_ -= gap_begin_ - offset;
+  }
+  else {
+    std::copy(data + gap_end_, data + gap_end_ + (offset - gap_begin_), data + gap_begin_);
+    gap_end_ += offset - gap_begin_;
+  }
+  gap_begin_ = offset;
+}
+
+
+void
+Incremental_Lexer::move_token_gap(size_t index)
+{
+  while (token_gap_begin_ > index) {
+    --token_gap_begin_;
+    --token_gap_end_;
+    entries_[token_gap_end_] = entries_[token_gap_begin_];
+    entries_[token_gap_end_].token = flipped(entries_[token_gap_end_].token);
+  }
+  while (token_gap_begin_ < index) {
+    entries_[token_gap_begin_] = entries_[token_gap_end_];
+    entries_[token_gap_begin_].token = flipped(entries_[token_gap_end_].token);
+    ++token_gap_begin_;
+    ++token_gap_end_;
+  }
+}
+
+
+/**
+ * Converts a token between offsets from the start and from the end of the
+ * document, which are kept for tokens before and after the gap respectively.
+ */
+Incremental_Lexer::Token
+Incremental_Lexer::flipped(Token token) const
+{
+  token.offset = size() - token.offset;
+  token.examined_end = size() + 1 - token.examined_end;
+  return token;
+}
+
+
+size_t
+Incremental_Lexer::lookback(size_t index) const
+{
+  if (index == token_count()) {
+    return end_lookback_;
+  }
+  return entries_[index < token_gap_begin_ ? index : index + token_gap_end_ - token_gap_begin_].lookback;
+}
+
+
+void
+Incremental_Lexer::set_lookback(size_t index, size_t lookback)
+{
+  if (index == token_count()) {
+    end_lookback_ = lookback;
+  }
+  else {
+    entries_[index < token_gap_begin_ ? index : index + token_gap_end_ - token_gap_begin_].lookback = lookback;
+  }
+}
+
+
+/**
+ * Works out the lookback of the token at `index`, or of the end of the
+ * document, from that of the token before.  Any token which looked beyond
+ * the end of that token also looked beyond the end of the one before it, so
+ * only tokens from its first such token on need checking.
+ */
+size_t
+Incremental_Lexer::find_lookback(size_t index) const
+{
+  if (index == 0) {
+    return 0;
+  }
+  auto const previous = token(index - 1);
+  auto const previous_end = previous.offset + previous.length;
+  for (auto i = index - 1 - lookback(index - 1); i < index; ++i) {
+    if (token(i).examined_end > previous_end) {
+      return index - i;
+    }
+  }
+  return 0;
+}
+
+
+/**
+ * Finds the first token which looked at the character at `offset`, or at the
+ * end of the document if that is where `offset` is.
+ */
+size_t
+Incremental_Lexer::first_damaged(size_t offset) const
+{
+  size_t low = 0;
+  size_t high = token_count();
+  while (low < high) {
+    auto const middle = low + (high - low) / 2;
+    auto const found = token(middle);
+    if (offset < found.offset + found.length) {
+      high = middle;
+    }
+    else {
+      low = middle + 1;
+    }
+  }
+
+  // Tokens before `low` end at or before `offset`, so any which looked at it
+  // looked beyond the end of the token before `low`.
+  for (auto i = low - lookback(low); i < low; ++i) {
+    if (token(i).examined_end > offset) {
+      return i;
+    }
+  }
+  return low;
 }
 
 } // namespace parka
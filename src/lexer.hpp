@@ -1,15 +1,50 @@
 #pragma once
 
+#include "byte_runs.hpp"
+#include "keyword_table.hpp"
+#include "mapped_file.hpp"
 #include "regex.hpp"
+#include "scanner.hpp"
 #include "streams.hpp"
 #include "string.hpp"
 #include "symbol.hpp"
 #include "token.hpp"
 
+#include <array>
+#include <deque>
 #include <iosfwd>
 #include <list>
+#include <vector>
 
 namespace parka {
+
+/**
+ * The engine a Lexer uses to match its patterns.
+ */
+enum class Lexer_Backend {
+  /// Use the compiled Scanner, unless a pattern requires std::regex.
+  automatic,
+
+  /// Always try each pattern in turn with std::regex.
+  regex
+};
+
+/**
+ * How `Lexer::lex_parallel` divides its input.
+ */
+struct Parallel_Lex_Options {
+  /// Number of threads, including the calling thread; 0 for one per core.
+  size_t thread_count = 0;
+
+  /// Chunks start just after this character, where a token is least likely
+  /// to continue across the split.
+  char_type split_after = '\n';
+
+  /// Inputs are not split into chunks smaller than this.
+  size_t min_chunk_size = 64 * 1024;
+};
+
+
 /**
  * A black-box to perform lexical analysis.  Provides configuration which it
  * uses to split up text into (possibly) numerous tokens_.  Lexers each are
@@ -22,15 +57,98 @@ namespace parka {
  * different input streams as you like, though you don't need to eat all the
  * tokens_ it produces to feed it more input.
  *
+ * Input is lexed on demand, one token at a time as they are taken, so tokens
+ * are never stored (see `Token_Range` to feed them straight to a parser).
+ * Patterns should therefore not be changed while input remains.
+ *
+ * Tokens refer to their lexemes within the lexer's copy of the input, so
+ * lexing does not allocate per token.  `next_token_view` gives such a token
+ * directly, which stays valid until the next call to `lex`, while
+ * `next_token` copies the lexeme out.  `lex_borrowed` and `lex_file` avoid even
+ * copying the input.
+ *
  * @section Error detection and handling.
  * If there are no patterns matching the current input, the lexer will give a
  * lexical exception along with the offending string.  Following this, it will
  * continue lexing, but only after it finds an matched and ignored pattern.
+ *
+ * @section Matching
+ * All patterns are compiled together into a single Scanner (DFA), so the
+ * matching pattern is found in one pass regardless of how many patterns there
+ * are.  Patterns using features the Scanner does not support cause the lexer
+ * to try each pattern in turn with std::regex instead, though only those
+ * which can start with the current character.
+ *
+ * Keywords made of word characters are kept out of the patterns altogether.
+ * Wherever a word starts, the whole word is looked up in a `Keyword_Table`,
+ * and a keyword found there wins over patterns registered after it.
  */
 class Lexer {
-  string ignore_characters_;
-  std::list<std::pair<regex, Symbol>> token_patterns_;
-  std::list<Token> tokens_;
+  friend class Incremental_Lexer;
+  friend class Stream_Lexer;
+
+  /**
+   * The pattern matching at a position, if any.
+   */
+  struct Match {
+    /// Token of the matched pattern or keyword, or null.
+    Symbol const * symbol;
+    size_t length;
+
+    /// Number of characters the result depends on, as for `Scanner::Match`.
+    size_t examined;
+
+    /// Input beyond the end of what was given could change the result.
+    bool needs_input;
+  };
+
+  // Ignored bytes, as a table for single bytes and as ranges for skipping runs.
+  std::array<bool, 256> ignored_;
+  Byte_Ranges ignored_ranges_;
+  bool ignored_ranges_usable_;
+
+  Byte_Ranges word_ranges_;
+  Keyword_Table keywords_;
+
+  std::vector<std::pair<regex, Symbol>> token_patterns_;
+
+  // Inputs owned by the lexer, kept for as long as tokens may refer to them.
+  std::list<string> sources_;
+  std::list<Mapped_File> mapped_files_;
+
+  // Ranges of input which remain to be lexed, in order.
+  std::deque<std::pair<char_type const *, char_type const *>> inputs_;
+  Token_View next_;
+  bool has_next_;
+
+  // Indices into token_patterns_, in priority order, of the patterns which
+  // can begin with each byte.
+  std::array<std::vector<size_t>, 256> patterns_by_first_byte_;
+
+  Lexer_Backend backend_;
+  Scanner scanner_;
+  bool scanner_supports_patterns_;
+  bool scanner_is_compiled_;
+
+  void add_pattern(regex const & expression, string const & pattern, string const & token_name);
+  void compile_patterns();
+  bool scanner_is_usable() const;
+
+  char_type const * skip_ignored(char_type const * current, char_type const * end) const;
+  Match match(char_type const * current, char_type const * end, bool at_end_of_input) const;
+  bool lex_next(
+      char_type const ** current,
+      char_type const * end,
+      Token_View * token,
+      size_t * examined = nullptr) const;
+  void lex_chunk(
+      char_type const * begin,
+      char_type const * stop,
+      char_type const * end,
+      std::vector<Token_View> * tokens,
+      std::vector<char_type const *> * positions) const;
+  void release_sources();
+  string & new_source();
 
 public:
   Lexer();
@@ -38,15 +156,163 @@ public:
   void register_pattern_for_token(string const & pattern, string const & token_name);
   void register_keyword(string const & keyword);
 
+  void set_backend(Lexer_Backend backend) { backend_ = backend; }
+
   void lex(string const & str);
   void lex(istream & input);
+  void lex_borrowed(char_type const * data, size_t size);
+  void lex_file(string const & path);
+
+  std::vector<Token_View> lex_parallel(string const & str, Parallel_Lex_Options const & options = Parallel_Lex_Options());
+  std::vector<Token_View> lex_parallel(
+      char_type const * data,
+      size_t size,
+      Parallel_Lex_Options const & options = Parallel_Lex_Options());
 
-  bool has_next_token() const;
+  bool has_next_token();
   Token next_token();
+  Token_View next_token_view();
 
   bool is_ignored(char ch) const {
-    return std::find(ignore_characters_.cbegin(), ignore_characters_.cend(), ch) != ignore_characters_.cend();
+    return ignored_[static_cast<unsigned char>(ch)];
   }
 };
 
+
+/**
+ * Lexes an input stream through a fixed size window, producing tokens only as
+ * they are requested.  Memory use depends on the window size and the longest
+ * token, rather than on the size of the input, so this is suitable for inputs
+ * too large to hold in memory.
+ *
+ * Tokens may cross the boundaries of the chunks read into the window, and a
+ * token longer than the window grows it to fit.  The exception is when the
+ * lexer uses the std::regex backend, which cannot tell if a pattern failed to
+ * match only because the input was cut short, so tokens which may do this
+ * must be no longer than half the window.
+ *
+ * The lexer and stream must outlive the Stream_Lexer, and the lexer's patterns
+ * must not be changed while it is in use.  Tokens from `next_token_view` refer
+ * into the window, so are only valid until the next token is requested.
+ */
+class Stream_Lexer {
+  Lexer & lexer_;
+  istream & input_;
+
+  // Characters of the input from window_[begin_] to window_[end_] remain to be
+  // lexed.
+  std::vector<char_type> window_;
+  size_t begin_;
+  size_t end_;
+  bool at_end_of_input_;
+
+  Token_View next_;
+  bool has_next_;
+
+  void refill();
+  bool advance();
+
+public:
+  static constexpr size_t default_window_size = 16 * 1024;
+
+  Stream_Lexer(Lexer & lexer, istream & input, size_t window_size = default_window_size);
+
+  bool has_next_token();
+  Token next_token();
+  Token_View next_token_view();
+
+  size_t window_size() const { return window_.size(); }
+};
+
+
+/**
+ * A document kept lexed as it is edited, such as in an editor.  After each
+ * edit, only the tokens which could have changed are lexed again, so the cost
+ * depends on the size of the edit rather than of the document.
+ *
+ * Each token records how far beyond its start the lexer looked to produce it.
+ * An edit damages the tokens which looked at any of the edited characters.
+ * Lexing restarts after the last undamaged token, and stops once a new token
+ * starts where an old token started after the edit: from there on, the lexer
+ * sees the same characters as before, so produces the same tokens.
+ *
+ * The text and the tokens are both kept in gap buffers, with the gap where the
+ * last edit started lexing again.  Tokens after the gap keep their offsets
+ * from the end of the document, so an edit never touches the tokens beyond
+ * it, and only moves the text and tokens between it and the previous edit.
+ * To find the damaged tokens without looking back over the whole document,
+ * each token also records how many tokens back the first token which looked
+ * beyond the end of the previous token is.
+ *
+ * The document is lexed exactly as is, like `Lexer::lex_borrowed`.  With the
+ * regex backend, how far the lexer looked is unknown, so lexing restarts from
+ * the beginning, though still stops soon after the edit.
+ */
+class Incremental_Lexer {
+public:
+  struct Token {
+    Symbol symbol;
+    size_t offset;
+    size_t length;
+
+    /// Offset of the first character the token does not depend on, which
+    /// is one past the end of the document if the end could change it.
+    size_t examined_end;
+  };
+
+  /**
+   * The tokens replaced by an edit: `removed` tokens starting at `first` were
+   * replaced by `inserted` new ones.
+   */
+  struct Relexed {
+    size_t first;
+    size_t removed;
+    size_t inserted;
+  };
+
+  Incremental_Lexer(Lexer & lexer, string text);
+
+  Relexed edit(size_t offset, size_t removed, string const & inserted);
+
+  size_t size() const { return buffer_.size() - (gap_end_ - gap_begin_); }
+  string text() const;
+
+  size_t token_count() const { return entries_.size() - (token_gap_end_ - token_gap_begin_); }
+  Token token(size_t index) const;
+
+  /// The token with its lexeme, which stays valid until the next edit.
+  Token_View token_view(size_t index) const;
+
+private:
+  struct Entry {
+    Token token;
+
+    /// Number of tokens back to the first which looked beyond the end of the
+    /// token before this one, or 0 if none did.
+    size_t lookback;
+  };
+
+  Lexer & lexer_;
+
+  std::vector<char_type> buffer_;
+  size_t gap_begin_;
+  size_t gap_end_;
+
+  std::vector<Entry> entries_;
+  size_t token_gap_begin_;
+  size_t token_gap_end_;
+
+  // As for `Entry::lookback`, for the end of the document.
+  size_t end_lookback_;
+
+  char_type const * text_at(size_t offset) const;
+  void move_gap(size_t offset);
+  void move_token_gap(size_t index);
+  Token flipped(Token token) const;
+  size_t lookback(size_t index) const;
+  void set_lookback(size_t index, size_t lookback);
+  size_t find_lookback(size_t index) const;
+  size_t first_damaged(size_t offset) const;
+};
+
 } // namespace parka
@@ -3,6 +3,18 @@
 #include "lexer.hpp"
 #include "streams.hpp"
 #include "string.hpp"
+#include "token_range.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <tuple>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
 using namespace parka;
 
 
@@ -82,6 +94,39 @@ TEST_F(Lexer_Test, Keywords_As_Part_Of_Identifiers) {
 }
 
 
+TEST_F(Lexer_Test, Keyword_Priority) {
+  Lexer lexer;
+  lexer.register_keyword("co-op");
+  lexer.register_keyword("if");
+  lexer.register_pattern_for_token("[a-z]+", "word");
+  lexer.register_pattern_for_token("-", "-");
+  lexer.register_keyword("else");
+
+  lexer.lex("if co-op co-opt else iffy");
+
+  // Keywords registered after a matching pattern never match, as before.
+  std::vector<std::pair<string, string>> expected = {
+    {"if", "if"}, {"co-op", "co-op"}, {"word", "co"}, {"-", "-"}, {"word", "opt"}, {"word", "else"}, {"word", "iffy"}};
+  ASSERT_FIND_EXPECTED_TOKENS(expected, lexer);
+}
+
+
+TEST_F(Lexer_Test, Many_Keywords) {
+  Lexer lexer;
+  std::vector<string> keywords;
+  for (size_t i = 0; i < 80; ++i) {
+    keywords.push_back("kw" + std::to_string(i));
+    lexer.register_keyword(keywords.back());
+  }
+  lexer.register_pattern_for_token("[a-z_][a-z_0-9]*", "identifier");
+
+  lexer.lex("kw0 kw79 kw80 kw7x k");
+  std::vector<std::pair<string, string>> expected = {
+    {"kw0", "kw0"}, {"kw79", "kw79"}, {"identifier", "kw80"}, {"identifier", "kw7x"}, {"identifier", "k"}};
+  ASSERT_FIND_EXPECTED_TOKENS(expected, lexer);
+}
+
+
 TEST_F(Lexer_Test, Single_Function_Call) {
   Lexer lexer;
   lexer.register_pattern_for_token("[a-zA-Z_][a-zA-Z_0-9]*", "identifier");
@@ -116,6 +161,432 @@ TEST_F(Lexer_Test, Quoted_String) {
 }
 
 
+TEST_F(Lexer_Test, Scanner_Matches_Regex_Backend) {
+  auto const configure = [](Lexer & lexer) {
+    lexer.register_keyword("for");
+    lexer.register_keyword("in");
+    lexer.register_pattern_for_token("[a-zA-Z_][a-zA-Z_0-9]*", "identifier");
+    lexer.register_pattern_for_token("(-)?([1-9][0-9]*|0)", "integer");
+    lexer.register_pattern_for_token("\"([^\"\\\\]|(\\\\.))*\"", "quoted_string");
+    lexer.register_pattern_for_token("[(]", "(");
+    lexer.register_pattern_for_token("[)]", ")");
+    lexer.register_pattern_for_token("-", "-");
+  };
+  string const input = R"(
+  for x in range(0, -10) "in \"quotes\"" forin in2 007 -x
+  ? "unterminated)";
+
+  Lexer scanner_lexer;
+  configure(scanner_lexer);
+  scanner_lexer.lex(input);
+
+  Lexer regex_lexer;
+  configure(regex_lexer);
+  regex_lexer.set_backend(Lexer_Backend::regex);
+  regex_lexer.lex(input);
+
+  while (regex_lexer.has_next_token()) {
+    ASSERT_TRUE(scanner_lexer.has_next_token());
+    auto const expected = regex_lexer.next_token();
+    auto const actual = scanner_lexer.next_token();
+    EXPECT_EQ(expected.symbol, actual.symbol);
+    EXPECT_EQ(expected.lexeme, actual.lexeme);
+  }
+  EXPECT_FALSE(scanner_lexer.has_next_token());
+}
+
+
+TEST_F(Lexer_Test, Prefix_Alternatives_Match_Regex_Backend) {
+  auto const configure = [](Lexer & lexer) {
+    lexer.register_pattern_for_token("<|<=", "cmp");
+    lexer.register_pattern_for_token("=", "eq");
+    lexer.register_pattern_for_token("[a-z]+|[a-z]+[0-9]+", "id");
+    lexer.register_pattern_for_token("[0-9]+", "num");
+  };
+  string const input = "a<=b ab12";
+
+  std::vector<std::pair<string, string>> expected = {
+    {"id", "a"}, {"cmp", "<"}, {"eq", "="}, {"id", "b"},
+    {"id", "ab"}, {"num", "12"}};
+  for (auto const backend : {Lexer_Backend::automatic, Lexer_Backend::regex}) {
+    Lexer lexer;
+    configure(lexer);
+    lexer.set_backend(backend);
+    lexer.lex(input);
+    ASSERT_FIND_EXPECTED_TOKENS(expected, lexer);
+  }
+}
+
+
+TEST_F(Lexer_Test, Greedy_Repetition_Matches_Regex_Backend) {
+  auto const configure = [](Lexer & lexer) {
+    lexer.register_pattern_for_token("a*(ab)?", "as");
+    lexer.register_pattern_for_token("b", "b");
+  };
+  string const input = "aab ab";
+
+  std::vector<std::pair<string, string>> expected = {
+    {"as", "aa"}, {"b", "b"}, {"as", "a"}, {"b", "b"}};
+  for (auto const backend : {Lexer_Backend::automatic, Lexer_Backend::regex}) {
+    Lexer lexer;
+    configure(lexer);
+    lexer.set_backend(backend);
+    lexer.lex(input);
+    ASSERT_FIND_EXPECTED_TOKENS(expected, lexer);
+  }
+}
+
+
+TEST_F(Lexer_Test, Unsupported_Pattern_Uses_Regex) {
+  Lexer lexer;
+  lexer.register_pattern_for_token("([a-z])\\1", "double");
+  lexer.register_pattern_for_token("[a-z]+", "word");
+  lexer.lex("aa ab");
+
+  std::vector<std::pair<string, string>> expected = {
+    {"double", "aa"}, {"word", "ab"}};
+  ASSERT_FIND_EXPECTED_TOKENS(expected, lexer);
+}
+
+
+TEST_F(Lexer_Test, Empty_Matches_Ignored) {
+  for (auto const backend : {Lexer_Backend::automatic, Lexer_Backend::regex}) {
+    Lexer lexer;
+    lexer.set_backend(backend);
+    lexer.register_pattern_for_token("a*", "as");
+    lexer.register_pattern_for_token("b", "b");
+    lexer.lex("aab b");
+
+    std::vector<std::pair<string, string>> expected = {
+      {"as", "aa"}, {"b", "b"}, {"b", "b"}};
+    ASSERT_FIND_EXPECTED_TOKENS(expected, lexer);
+  }
+}
+
+
+TEST_F(Lexer_Test, Stream_Matches_Lex) {
+  auto const configure = [](Lexer & lexer) {
+    lexer.register_keyword("for");
+    lexer.register_pattern_for_token("[a-zA-Z_][a-zA-Z_0-9]*", "identifier");
+    lexer.register_pattern_for_token("(-)?([1-9][0-9]*|0)", "integer");
+    lexer.register_pattern_for_token("\"([^\"\\\\]|(\\\\.))*\"", "quoted_string");
+  };
+  string const input = "for forever 12345678 \"a string crossing\\\" many windows\" x for";
+
+  for (auto const backend : {Lexer_Backend::automatic, Lexer_Backend::regex}) {
+    Lexer expected_lexer;
+    configure(expected_lexer);
+    expected_lexer.lex(input);
+
+    Lexer lexer;
+    configure(lexer);
+    lexer.set_backend(backend);
+    stringstream ss(input);
+
+    // The regex backend requires a window of at least twice the longest token.
+    auto const window_size = backend == Lexer_Backend::regex ? 96 : 4;
+    Stream_Lexer stream(lexer, ss, window_size);
+    while (expected_lexer.has_next_token()) {
+      ASSERT_TRUE(stream.has_next_token());
+      auto const expected = expected_lexer.next_token();
+      auto const actual = stream.next_token();
+      EXPECT_EQ(expected.symbol, actual.symbol);
+      EXPECT_EQ(expected.lexeme, actual.lexeme);
+    }
+    EXPECT_FALSE(stream.has_next_token());
+  }
+}
+
+
+TEST_F(Lexer_Test, Stream_Window_Bounded_By_Longest_Token) {
+  Lexer lexer;
+  lexer.register_pattern_for_token("[a-z]+", "word");
+  lexer.register_pattern_for_token("[0-9]+", "number");
+
+  stringstream ss;
+  for (auto i = 0; i < 10000; ++i) {
+    ss << "word " << i << '\n';
+  }
+  ss << string(100, 'x');
+
+  Stream_Lexer stream(lexer, ss, 64);
+  size_t count = 0;
+  string last;
+  while (stream.has_next_token()) {
+    last = stream.next_token().lexeme;
+    ++count;
+  }
+  EXPECT_EQ(20001u, count);
+  EXPECT_EQ(string(100, 'x'), last);
+  EXPECT_EQ(128u, stream.window_size());
+}
+
+
+TEST_F(Lexer_Test, Token_Views_Refer_To_Input) {
+  Lexer lexer;
+  lexer.register_pattern_for_token("[a-zA-Z_][a-zA-Z_0-9]*", "identifier");
+
+  string const input = "alpha beta";
+  lexer.lex_borrowed(input.data(), input.size());
+
+  ASSERT_TRUE(lexer.has_next_token());
+  auto const alpha = lexer.next_token_view();
+  EXPECT_EQ(input.data(), alpha.lexeme.data());
+  EXPECT_EQ("alpha", alpha.lexeme);
+
+  ASSERT_TRUE(lexer.has_next_token());
+  auto const beta = lexer.next_token_view();
+  EXPECT_EQ(input.data() + 6, beta.lexeme.data());
+  EXPECT_EQ("beta", beta.lexeme.str());
+  EXPECT_FALSE(lexer.has_next_token());
+}
+
+
+TEST_F(Lexer_Test, Token_Views_Survive_Further_Input) {
+  Lexer lexer;
+  lexer.register_pattern_for_token("[a-z]+", "word");
+  lexer.lex("first");
+  lexer.lex("second");
+
+  // Tokens from the first input are still pending, so it must be kept.
+  std::vector<Token_View> views;
+  while (lexer.has_next_token()) {
+    views.push_back(lexer.next_token_view());
+  }
+  ASSERT_EQ(2u, views.size());
+  EXPECT_EQ("first", views[0].lexeme);
+  EXPECT_EQ("second", views[1].lexeme);
+}
+
+
+TEST_F(Lexer_Test, Token_Range_Ends_With_End_Marker) {
+  Lexer lexer;
+  lexer.register_pattern_for_token("[a-z]+", "word");
+  lexer.lex("one two");
+
+  std::vector<string> lexemes;
+  std::vector<Symbol> symbols;
+  auto tokens = token_range(lexer);
+  for (auto const & token : tokens) {
+    lexemes.push_back(token.lexeme);
+    symbols.push_back(token.symbol);
+  }
+  EXPECT_EQ((std::vector<string> {"one", "two", ""}), lexemes);
+  EXPECT_EQ((std::vector<Symbol> {"word"_sym, "word"_sym, Symbol::right_end_marker()}), symbols);
+  EXPECT_FALSE(lexer.has_next_token());
+}
+
+
+TEST_F(Lexer_Test, Lex_Mapped_File) {
+  auto const path = string(testing::TempDir()) + "lexer_ut_mapped_file.txt";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << "for x in list\n";
+  }
+
+  Lexer lexer;
+  lexer.register_keyword("for");
+  lexer.register_keyword("in");
+  lexer.register_pattern_for_token("[a-zA-Z_][a-zA-Z_0-9]*", "identifier");
+  lexer.lex_file(path);
+
+  std::vector<std::pair<string, string>> expected = {
+    {"for", "for"},
+    {"identifier", "x"},
+    {"in", "in"},
+    {"identifier", "list"}};
+  ASSERT_FIND_EXPECTED_TOKENS(expected, lexer);
+
+  // Empty files cannot be mapped, but are still valid input.
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  }
+  lexer.lex_file(path);
+  EXPECT_FALSE(lexer.has_next_token());
+  std::remove(path.c_str());
+
+  EXPECT_THROW(lexer.lex_file(path), std::system_error);
+}
+
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST_F(Lexer_Test, Lex_Pipe) {
+  // Pipes report no size, so must be read rather than mapped.
+  int fds[2];
+  ASSERT_EQ(0, ::pipe(fds));
+  string const input = "for x in list";
+  ASSERT_EQ(static_cast<ssize_t>(input.size()), ::write(fds[1], input.data(), input.size()));
+  ::close(fds[1]);
+
+  Lexer lexer;
+  lexer.register_keyword("for");
+  lexer.register_keyword("in");
+  lexer.register_pattern_for_token("[a-zA-Z_][a-zA-Z_0-9]*", "identifier");
+  lexer.lex_file("/dev/fd/" + std::to_string(fds[0]));
+  ::close(fds[0]);
+
+  std::vector<std::pair<string, string>> expected = {
+    {"for", "for"},
+    {"identifier", "x"},
+    {"in", "in"},
+    {"identifier", "list"}};
+  ASSERT_FIND_EXPECTED_TOKENS(expected, lexer);
+}
+#endif
+
+
+#if defined(__linux__)
+TEST_F(Lexer_Test, Lex_Proc_File) {
+  // Files under /proc report a size of zero, but still have contents.
+  string const path = "/proc/self/comm";
+  std::ifstream file(path);
+  string name;
+  ASSERT_TRUE(std::getline(file, name));
+  ASSERT_FALSE(name.empty());
+
+  Lexer lexer;
+  lexer.register_pattern_for_token("[^\n]+", "line");
+  lexer.lex_file(path);
+
+  std::vector<std::pair<string, string>> expected = {{"line", name}};
+  ASSERT_FIND_EXPECTED_TOKENS(expected, lexer);
+}
+#endif
+
+
+TEST_F(Lexer_Test, Parallel_Matches_Lex) {
+  auto const configure = [](Lexer & lexer) {
+    lexer.register_keyword("for");
+    lexer.register_keyword("in");
+    lexer.register_pattern_for_token("/[*]([^*]|[*]+[^*/])*[*]+/", "comment");
+    lexer.register_pattern_for_token("[a-zA-Z_][a-zA-Z_0-9]*", "identifier");
+    lexer.register_pattern_for_token("[0-9]+", "integer");
+    lexer.register_pattern_for_token("\"([^\"\\\\]|(\\\\.))*\"", "quoted_string");
+  };
+
+  // Strings and comments spanning lines make chunks start within tokens.
+  std::vector<string> const pieces = {
+    "for", "in", "x", "y1", "42", "\n", " ", "\"a\nb\"", "/* a\n*/", "/*\nfor x\n*/", "\"\\\"\n\"", "?", "\t"};
+  std::mt19937 random(3);
+  for (size_t trial = 0; trial < 50; ++trial) {
+    string input;
+    for (size_t i = random() % 2000; i > 0; --i) {
+      input += pieces[random() % pieces.size()];
+    }
+
+    Lexer serial;
+    configure(serial);
+    serial.lex(input);
+    std::vector<std::pair<Symbol, string>> expected;
+    while (serial.has_next_token()) {
+      auto const token = serial.next_token();
+      expected.emplace_back(token.symbol, token.lexeme);
+    }
+
+    for (size_t threads : {1, 2, 3, 8}) {
+      Lexer parallel;
+      configure(parallel);
+      Parallel_Lex_Options options;
+      options.thread_count = threads;
+      options.min_chunk_size = 16;
+      options.split_after = trial % 2 == 0 ? '\n' : ' ';
+
+      std::vector<std::pair<Symbol, string>> actual;
+      for (auto const & token : parallel.lex_parallel(input, options)) {
+        actual.emplace_back(token.symbol, token.lexeme);
+      }
+      ASSERT_EQ(expected, actual) << threads << " threads: " << input;
+    }
+  }
+}
+
+
+TEST_F(Lexer_Test, Incremental_Matches_Lex) {
+  auto const configure = [](Lexer & lexer, Lexer_Backend backend) {
+    lexer.set_backend(backend);
+    lexer.register_keyword("for");
+    lexer.register_keyword("in");
+    lexer.register_pattern_for_token("/[*]([^*]|[*]+[^*/])*[*]+/", "comment");
+    lexer.register_pattern_for_token("[a-zA-Z_][a-zA-Z_0-9]*", "identifier");
+    lexer.register_pattern_for_token("[0-9]+", "integer");
+    lexer.register_pattern_for_token("\"([^\"\\\\]|(\\\\.))*\"", "quoted_string");
+    lexer.register_pattern_for_token("[/]", "/");
+  };
+  auto const lex = [&](string const & text, Lexer_Backend backend) {
+    Lexer lexer;
+    configure(lexer, backend);
+    lexer.lex_borrowed(text.data(), text.size());
+    std::vector<std::tuple<Symbol, size_t, size_t>> tokens;
+    while (lexer.has_next_token()) {
+      auto const token = lexer.next_token_view();
+      tokens.emplace_back(token.symbol, static_cast<size_t>(token.lexeme.data() - text.data()), token.lexeme.size());
+    }
+    return tokens;
+  };
+
+  std::vector<string> const pieces = {"for", "in", "x", "1", " ", "\n", "\"", "/", "*", "\\", "?"};
+  std::mt19937 random(5);
+  for (auto const backend : {Lexer_Backend::automatic, Lexer_Backend::regex}) {
+    Lexer lexer;
+    configure(lexer, backend);
+    Incremental_Lexer document(lexer, "for x in 12 /* c */ \"s\"\n");
+    for (size_t edit = 0; edit < 1000; ++edit) {
+      auto const offset = random() % (document.size() + 1);
+      auto const removed = std::min<size_t>(random() % 4, document.size() - offset);
+      string inserted;
+      for (auto count = random() % 4; count > 0; --count) {
+        inserted += pieces[random() % pieces.size()];
+      }
+      document.edit(offset, removed, inserted);
+
+      std::vector<std::tuple<Symbol, size_t, size_t>> actual;
+      for (size_t i = 0; i < document.token_count(); ++i) {
+        auto const token = document.token(i);
+        actual.emplace_back(token.symbol, token.offset, token.length);
+      }
+      ASSERT_EQ(lex(document.text(), backend), actual) << document.text();
+    }
+  }
+}
+
+
+TEST_F(Lexer_Test, Incremental_Relexes_Only_Edit) {
+  Lexer lexer;
+  lexer.register_keyword("for");
+  lexer.register_pattern_for_token("[a-zA-Z_][a-zA-Z_0-9]*", "identifier");
+  lexer.register_pattern_for_token("\"[^\"]*\"", "quoted_string");
+
+  string text;
+  for (size_t i = 0; i < 1000; ++i) {
+    text += "for x \"y\"\n";
+  }
+  Incremental_Lexer document(lexer, text);
+  ASSERT_EQ(3000u, document.token_count());
+
+  // Turns the keyword on line 500 into an identifier.
+  auto relexed = document.edit(500 * 10 + 3, 0, "m");
+  EXPECT_EQ(1500u, relexed.first);
+  EXPECT_EQ(1u, relexed.removed);
+  EXPECT_EQ(1u, relexed.inserted);
+  EXPECT_EQ("identifier", document.token_view(1500).symbol.repr());
+  EXPECT_EQ("form", document.token_view(1500).lexeme.str());
+  EXPECT_EQ("x", document.token_view(1501).lexeme.str());
+
+  // An opening quote turns the text between every pair of strings into a
+  // string, so nothing lines up again.
+  relexed = document.edit(0, 0, "\"");
+  EXPECT_EQ(0u, relexed.first);
+  EXPECT_EQ(3000u, relexed.removed);
+  EXPECT_EQ(2000u, document.token_count());
+  EXPECT_EQ("\"for x \"", document.token_view(0).lexeme.str());
+
+  relexed = document.edit(0, 1, "");
+  EXPECT_EQ(3000u, document.token_count());
+  EXPECT_EQ("for", document.token_view(0).lexeme.str());
+
+  EXPECT_THROW(document.edit(document.size(), 1, ""), std::out_of_range);
+}
+
 int main(int argc, char ** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
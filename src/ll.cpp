@@ -2,7 +2,66 @@
 
 #include "streams.hpp"
 
+#include <algorithm>
+
 namespace parka {
+  /**
+   * Adds the entries for the alternatives of `head` to `parsing_table`.
+   */
+  static bool
+  add_predictive_parsing_table_row(
+      Grammar const & grammar
+    , Symbol const & head
+    , Symbol_String_Alternatives const & alternatives
+    , Predictive_Parsing_Table * parsing_table)
+  {
+    auto const & follow_a = grammar.follow(head);
+    for (auto const & alternative : alternatives) {
+      // Local macro to simplify error handling and reporting.
+#define fail_if_insert_over_existing_mapping(elem, some_production)   \
+      if (parsing_table->count(Symbol_Pair(head, elem)) != 0) {       \
+        std::cerr << "Ambiguity creating predicting parser table: "   \
+        << '[' << head << ',' << elem << "] already mapped to "       \
+        << (*parsing_table)[Symbol_Pair(head,elem)].first << " -> "   \
+        << '"' << (*parsing_table)[Symbol_Pair(head,elem)].second << '"' \
+        << " but tried to insert " << some_production.first << " -> "    \
+        << '"' << some_production.second << '"' << '\n';              \
+        return false;                                                 \
+      }
+
+      auto const current_production = Production(head, alternative);
+
+      // Add A -> alpha for each terminal in a.
+      // This was an errata in the Dragon Book
+      // using first(alternative) instead of first(head), though this could
+      // just be a unclear interpretation of the text.
+      auto const first_alt = grammar.first(alternative);
+      for (auto const & a : first_alt) {
+        if (a != Symbol::empty()) {
+          fail_if_insert_over_existing_mapping(a, current_production);
+          (*parsing_table)[Symbol_Pair(head, a)] = current_production;
+        }
+      }
+
+      // Adds A -> alpha for follow and right end marker (if applicable)
+      if (first_alt.count(Symbol::empty()) > 0) {
+        for (auto const & b : follow_a) {
+          if (b != Symbol::empty() && b != Symbol::right_end_marker()) {
+            fail_if_insert_over_existing_mapping(b, current_production);
+            (*parsing_table)[Symbol_Pair(head, b)] = current_production;
+          }
+        }
+
+        if (follow_a.count(Symbol::right_end_marker()) > 0) {
+          fail_if_insert_over_existing_mapping(Symbol::right_end_marker(), current_production);
+          (*parsing_table)[Symbol_Pair(head, Symbol::right_end_marker())] = current_production;
+        }
+      }
+#undef fail_if_insert_over_existing_mapping
+    }
+    return true;
+  }
+
   /**
    * Creates a predictive parsing table (for a recursive-decent parser with no
    * backtracking) if possible for a LL(1) grammar.
@@ -32,53 +91,303 @@ namespace parka {
     }
 
     for (auto const & production : grammar.productions()) {
-      auto const head = production.first;
+      if (!add_predictive_parsing_table_row(grammar, production.first, production.second, parsing_table)) {
+        return false;
+      }
+    }
+    return true;
+  }
 
-      for (auto const & alternative : production.second) {
-        // Local macro to simplify error handling and reporting.
-#define fail_if_insert_over_existing_mapping(elem, some_production)   \
-        if (parsing_table->count(Symbol_Pair(head, elem)) != 0) {     \
-          std::cerr << "Ambiguity creating predicting parser table: " \
-          << '[' << head << ',' << elem << "] already mapped to "     \
-          << (*parsing_table)[Symbol_Pair(head,elem)].first << " -> " \
-          << '"' << (*parsing_table)[Symbol_Pair(head,elem)].second << '"' \
-          << " but tried to insert " << some_production.first << " -> "    \
-          << '"' << some_production.second << '"' << '\n';            \
-          return false;                                               \
-        }
+  bool
+  update_predictive_parsing_table(
+      Grammar const & grammar
+    , Symbol_Set const & changed_heads
+    , Predictive_Parsing_Table * parsing_table)
+  {
+    if (parsing_table == nullptr) {
+      return false;
+    }
+
+    // Entries are ordered by head first, so each row is a contiguous range.
+    for (auto const & head : changed_heads) {
+      auto const row_begin = parsing_table->lower_bound(Symbol_Pair(head, Symbol::empty()));
+      auto row_end = row_begin;
+      while (row_end != parsing_table->end() && row_end->first.first == head) {
+        ++row_end;
+      }
+      parsing_table->erase(row_begin, row_end);
+    }
+
+    for (auto const & head : changed_heads) {
+      if (!add_predictive_parsing_table_row(grammar, head, grammar[head], parsing_table)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  constexpr Dense_Parsing_Table::Production_Index Dense_Parsing_Table::no_production;
+  constexpr std::uint32_t Dense_Parsing_Table::no_index;
+
+  Dense_Parsing_Table::Dense_Parsing_Table()
+  : row_count_(0)
+  , column_count_(0)
+  {
+  }
+
+  void
+  Dense_Parsing_Table::assign_index(std::vector<std::uint32_t> & indices, size_t & count, Symbol const & symbol)
+  {
+    if (symbol.id() >= indices.size()) {
+      indices.resize(symbol.id() + 1, no_index);
+    }
+    if (indices[symbol.id()] == no_index) {
+      indices[symbol.id()] = static_cast<std::uint32_t>(count++);
+    }
+  }
+
+  Dense_Parsing_Table::Dense_Parsing_Table(Predictive_Parsing_Table const & table)
+  : row_count_(0)
+  , column_count_(0)
+  {
+    // Identical productions share an index, so each body is stored once.
+    std::map<Production, Production_Index> production_indices;
+    for (auto const & entry : table) {
+      assign_index(rows_, row_count_, entry.first.first);
+      assign_index(columns_, column_count_, entry.first.second);
+      if (production_indices.emplace(entry.second, static_cast<Production_Index>(productions_.size())).second) {
+        productions_.push_back(entry.second);
+      }
+    }
+
+    cells_.assign(row_count_ * column_count_, no_production);
+    for (auto const & entry : table) {
+      auto const row = index_of(rows_, entry.first.first);
+      auto const column = index_of(columns_, entry.first.second);
+      cells_[row * column_count_ + column] = production_indices.at(entry.second);
+    }
+  }
 
-        auto const current_production = Production(head, alternative);
-
-        // Add A -> alpha for each terminal in a.
-        // This was an errata in the Dragon Book
-        // using first(alternative) instead of first(head), though this could
-        // just be a unclear interpretation of the text.
-        auto const first_alt = grammar.first(alternative);
-        for (auto const a : first_alt) {
-          if (a != Symbol::empty()) {
-            fail_if_insert_over_existing_mapping(a, current_production);
-            (*parsing_table)[Symbol_Pair(head, a)] = current_production;
+  /**
+   * Each alternative of A goes in the cells for the terminals of its FIRST,
+   * and for FOLLOW(A) if it can produce empty.  FIRST and FOLLOW come from the
+   * grammar's analyses, computed once for all alternatives.
+   */
+  bool
+  create_dense_parsing_table(
+      Grammar const & grammar
+    , Dense_Parsing_Table * parsing_table
+    , std::vector<Parsing_Table_Conflict> * conflicts)
+  {
+    if (parsing_table == nullptr) {
+      return false;
+    }
+
+    Dense_Parsing_Table result;
+    size_t production_count = 0;
+    for (auto const & production : grammar.productions()) {
+      Dense_Parsing_Table::assign_index(result.rows_, result.row_count_, production.first);
+      for (auto const & alternative : production.second) {
+        ++production_count;
+        for (auto const & body_symbol : alternative) {
+          if (body_symbol != Symbol::empty() && grammar.is_terminal(body_symbol)) {
+            Dense_Parsing_Table::assign_index(result.columns_, result.column_count_, body_symbol);
           }
         }
+      }
+    }
+    Dense_Parsing_Table::assign_index(result.columns_, result.column_count_, Symbol::right_end_marker());
+    result.cells_.assign(result.row_count_ * result.column_count_, Dense_Parsing_Table::no_production);
+    result.productions_.reserve(production_count);
+
+    bool succeeded = true;
+    for (auto const & production : grammar.productions()) {
+      auto const & head = production.first;
+      auto const row = result.cells_.begin() + Dense_Parsing_Table::index_of(result.rows_, head) * result.column_count_;
+      auto const & follow_head = grammar.follow(head);
 
-        auto const follow_a = grammar.follow(head);
-        // Adds A -> alpha for follow and right end marker (if applicable)
-        if (first_alt.count(Symbol::empty()) > 0) {
-          for (auto const b : follow_a) {
-            if (b != Symbol::empty() && b != Symbol::right_end_marker()) {
-              fail_if_insert_over_existing_mapping(b, current_production);
-              (*parsing_table)[Symbol_Pair(head, b)] = current_production;
+      for (auto const & alternative : production.second) {
+        auto const index = static_cast<Dense_Parsing_Table::Production_Index>(result.productions_.size());
+        result.productions_.emplace_back(head, alternative);
+
+        auto const fill = [&](Symbol const & terminal) {
+          auto & cell = row[Dense_Parsing_Table::index_of(result.columns_, terminal)];
+          if (cell == Dense_Parsing_Table::no_production) {
+            cell = index;
+          }
+          else if (cell != index) {
+            succeeded = false;
+            if (conflicts != nullptr) {
+              conflicts->push_back({head, terminal, result.productions_[cell], result.productions_[index]});
             }
           }
+        };
 
-          if (follow_a.count(Symbol::right_end_marker()) > 0) {
-            fail_if_insert_over_existing_mapping(Symbol::right_end_marker(), current_production);
-            (*parsing_table)[Symbol_Pair(head, Symbol::right_end_marker())] = current_production;
+        auto const first_alternative = grammar.first(alternative);
+        for (auto const & terminal : first_alternative) {
+          if (terminal != Symbol::empty()) {
+            fill(terminal);
+          }
+        }
+        if (first_alternative.count(Symbol::empty()) > 0) {
+          for (auto const & terminal : follow_head) {
+            fill(terminal);
           }
         }
-#undef fail_if_insert_over_existing_mapping
       }
     }
-    return true;
+
+    *parsing_table = std::move(result);
+    return succeeded;
+  }
+
+  ostream &
+  operator<<(ostream & os, Parsing_Table_Conflict const & conflict)
+  {
+    return os << '[' << conflict.nonterminal << ',' << conflict.terminal << "] "
+      << conflict.chosen.first << " -> " << '"' << conflict.chosen.second << '"'
+      << " conflicts with "
+      << conflict.rejected.first << " -> " << '"' << conflict.rejected.second << '"';
+  }
+
+  Parsing_Table_Footprint
+  Dense_Parsing_Table::footprint() const
+  {
+    Parsing_Table_Footprint result;
+    result.rows = row_count_;
+    result.columns = column_count_;
+    result.entries = cells_.size();
+    result.bytes = sizeof(Production_Index) * cells_.size()
+      + sizeof(std::uint32_t) * (rows_.size() + columns_.size());
+    return result;
+  }
+
+  constexpr Compressed_Parsing_Table::Production_Index Compressed_Parsing_Table::no_production;
+  constexpr std::uint32_t Compressed_Parsing_Table::no_index;
+
+  Compressed_Parsing_Table::Compressed_Parsing_Table(Dense_Parsing_Table const & table, bool default_entries)
+  : rows_(table.rows_)
+  , column_classes_(table.columns_.size(), no_index)
+  , column_class_count_(0)
+  , displacements_(table.row_count_, 0)
+  , defaults_(table.row_count_, no_production)
+  , productions_(table.productions_)
+  {
+    auto const row_count = table.row_count_;
+    auto const column_count = table.column_count_;
+    auto const cell = [&](size_t row, size_t column) {
+      return table.cells_[row * column_count + column];
+    };
+
+    // Columns with the same entry in every row share a class.
+    std::map<std::vector<Production_Index>, std::uint32_t> classes;
+    std::vector<std::uint32_t> class_of_column(column_count);
+    std::vector<size_t> column_of_class;
+    for (size_t column = 0; column < column_count; ++column) {
+      std::vector<Production_Index> entries(row_count);
+      for (size_t row = 0; row < row_count; ++row) {
+        entries[row] = cell(row, column);
+      }
+      auto const found = classes.emplace(std::move(entries), static_cast<std::uint32_t>(column_of_class.size()));
+      if (found.second) {
+        column_of_class.push_back(column);
+      }
+      class_of_column[column] = found.first->second;
+    }
+    column_class_count_ = column_of_class.size();
+    for (size_t id = 0; id < table.columns_.size(); ++id) {
+      if (table.columns_[id] != no_index) {
+        column_classes_[id] = class_of_column[table.columns_[id]];
+      }
+    }
+
+    // The entries each row keeps, as (class, production).
+    std::vector<std::vector<std::pair<std::uint32_t, Production_Index>>> row_entries(row_count);
+    for (size_t row = 0; row < row_count; ++row) {
+      if (default_entries) {
+        // Counted over the original columns, as those are the cells the
+        // default stands for.
+        std::map<Production_Index, size_t> counts;
+        for (size_t column = 0; column < column_count; ++column) {
+          auto const entry = cell(row, column);
+          if (entry != no_production) {
+            ++counts[entry];
+          }
+        }
+        size_t most = 0;
+        for (auto const & count : counts) {
+          if (count.second > most) {
+            most = count.second;
+            defaults_[row] = count.first;
+          }
+        }
+      }
+
+      for (size_t column_class = 0; column_class < column_class_count_; ++column_class) {
+        auto const entry = cell(row, column_of_class[column_class]);
+        if (entry != no_production && entry != defaults_[row]) {
+          row_entries[row].emplace_back(static_cast<std::uint32_t>(column_class), entry);
+        }
+      }
+    }
+
+    // Places the fullest rows first, each at the first displacement where its
+    // entries fit around those already placed.
+    std::vector<size_t> order(row_count);
+    for (size_t row = 0; row < row_count; ++row) {
+      order[row] = row;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+      return row_entries[lhs].size() > row_entries[rhs].size();
+    });
+
+    for (auto const row : order) {
+      auto const & entries = row_entries[row];
+      if (entries.empty()) {
+        continue;
+      }
+
+      size_t displacement = 0;
+      while (true) {
+        auto const fits = std::all_of(entries.begin(), entries.end(), [&](std::pair<std::uint32_t, Production_Index> const & entry) {
+          auto const slot = displacement + entry.first;
+          return slot >= owners_.size() || owners_[slot] == no_index;
+        });
+        if (fits) {
+          break;
+        }
+        ++displacement;
+      }
+
+      displacements_[row] = static_cast<std::uint32_t>(displacement);
+      auto const end = displacement + entries.back().first + 1;
+      if (end > owners_.size()) {
+        owners_.resize(end, no_index);
+        entries_.resize(end, no_production);
+      }
+      for (auto const & entry : entries) {
+        owners_[displacement + entry.first] = static_cast<std::uint32_t>(row);
+        entries_[displacement + entry.first] = entry.second;
+      }
+    }
+  }
+
+  Parsing_Table_Footprint
+  Compressed_Parsing_Table::footprint() const
+  {
+    Parsing_Table_Footprint result;
+    result.rows = displacements_.size();
+    result.columns = column_class_count_;
+    result.entries = entries_.size();
+    result.bytes = sizeof(Production_Index) * (entries_.size() + defaults_.size())
+      + sizeof(std::uint32_t) * (owners_.size() + displacements_.size() + rows_.size() + column_classes_.size());
+    return result;
+  }
+
+  ostream &
+  operator<<(ostream & os, Parsing_Table_Footprint const & footprint)
+  {
+    return os << footprint.rows << " rows, " << footprint.columns << " columns, "
+      << footprint.entries << " entries, " << footprint.bytes << " bytes";
   }
 } // namespace parka
@@ -3,8 +3,12 @@
 #include "grammar.hpp"
 #include "lexer.hpp"
 #include "streams.hpp"
+#include "token_range.hpp"
 
+#include <cstdint>
+#include <limits>
 #include <stack>
+#include <vector>
 
 namespace parka {
 
@@ -16,6 +20,237 @@ bool create_predictive_parsing_table(
   , Predictive_Parsing_Table * parsing_table);
 
 
+/**
+ * Brings a table made by `create_predictive_parsing_table` up to date after
+ * `Grammar::update_alternatives`, rebuilding only the rows of the heads it
+ * returned.  As with creating a table, its state is undefined if this fails.
+ */
+bool update_predictive_parsing_table(
+    Grammar const & grammar
+  , Symbol_Set const & changed_heads
+  , Predictive_Parsing_Table * parsing_table);
+
+
+/**
+ * Two productions competing for the same cell of a predictive parsing table,
+ * so the grammar is not LL(1).
+ */
+struct Parsing_Table_Conflict {
+  Symbol nonterminal;
+  Symbol terminal;
+
+  /// The production the table holds.
+  Production chosen;
+
+  /// The production which also applies.
+  Production rejected;
+};
+
+ostream & operator<<(ostream & os, Parsing_Table_Conflict const & conflict);
+
+
+/**
+ * Memory used by the lookup structures of a parsing table, not counting the
+ * productions themselves, which every table holds the same way.
+ */
+struct Parsing_Table_Footprint {
+  size_t rows;
+
+  /// Columns as stored, after merging any which are the same.
+  size_t columns;
+
+  /// Slots of the array holding the entries.
+  size_t entries;
+
+  size_t bytes;
+};
+
+ostream & operator<<(ostream & os, Parsing_Table_Footprint const & footprint);
+
+
+/**
+ * A predictive parsing table laid out for parsing: a dense array with a row
+ * for each nonterminal and a column for each terminal, indexed through the
+ * symbols' ids, so each lookup is a few array reads.  Cells hold a compact
+ * index into a side array holding each production once.
+ */
+class Dense_Parsing_Table {
+public:
+  using Production_Index = std::uint32_t;
+  static constexpr Production_Index no_production = std::numeric_limits<Production_Index>::max();
+
+  Dense_Parsing_Table();
+  explicit Dense_Parsing_Table(Predictive_Parsing_Table const & table);
+
+  /**
+   * The production to expand `nonterminal` by when `terminal` is next, or
+   * `no_production`.
+   */
+  Production_Index production_index(Symbol const & nonterminal, Symbol const & terminal) const
+  {
+    auto const row = index_of(rows_, nonterminal);
+    auto const column = index_of(columns_, terminal);
+    if (row == no_index || column == no_index) {
+      return no_production;
+    }
+    return cells_[row * column_count_ + column];
+  }
+
+  Production const & production(Production_Index index) const { return productions_[index]; }
+  std::vector<Production> const & productions() const { return productions_; }
+
+  size_t row_count() const { return row_count_; }
+  size_t column_count() const { return column_count_; }
+
+  Parsing_Table_Footprint footprint() const;
+
+private:
+  friend class Compressed_Parsing_Table;
+
+  static constexpr std::uint32_t no_index = std::numeric_limits<std::uint32_t>::max();
+
+  // Row and column of each symbol, by id.
+  std::vector<std::uint32_t> rows_;
+  std::vector<std::uint32_t> columns_;
+  size_t row_count_;
+  size_t column_count_;
+
+  std::vector<Production_Index> cells_;
+  std::vector<Production> productions_;
+
+  static std::uint32_t index_of(std::vector<std::uint32_t> const & indices, Symbol const & symbol)
+  {
+    return symbol.id() < indices.size() ? indices[symbol.id()] : no_index;
+  }
+
+  static void assign_index(std::vector<std::uint32_t> & indices, size_t & count, Symbol const & symbol);
+
+  friend bool create_dense_parsing_table(
+      Grammar const & grammar
+    , Dense_Parsing_Table * parsing_table
+    , std::vector<Parsing_Table_Conflict> * conflicts);
+};
+
+
+/**
+ * Builds a dense predictive parsing table in a single pass over the grammar,
+ * using its analyses, which are computed at most once.
+ *
+ * Rather than stopping at the first conflict, every one is added to
+ * `conflicts` if given, with the table keeping the first production found for
+ * each cell.  Returns false if there were any.
+ */
+bool create_dense_parsing_table(
+    Grammar const & grammar
+  , Dense_Parsing_Table * parsing_table
+  , std::vector<Parsing_Table_Conflict> * conflicts = nullptr);
+
+
+/**
+ * A dense table compressed for large grammars, whose tables are mostly empty
+ * and repetitive, while keeping lookups constant time.
+ *
+ * Terminals whose columns are the same in every row share a column.  The
+ * rows are then overlaid in a single array, each displaced so that its
+ * entries land in slots no other row uses, with a parallel array recording
+ * which row owns each slot.
+ *
+ * Optionally, the most common production of each row becomes its default,
+ * and is left out of the array.  Lookups which find no entry give the
+ * default, so the array shrinks further, but an unexpected terminal no longer
+ * fails at once: the parser expands by the default and fails when it next
+ * tries to match a terminal instead.
+ */
+class Compressed_Parsing_Table {
+public:
+  using Production_Index = Dense_Parsing_Table::Production_Index;
+  static constexpr Production_Index no_production = Dense_Parsing_Table::no_production;
+
+  explicit Compressed_Parsing_Table(Dense_Parsing_Table const & table, bool default_entries = false);
+
+  Production_Index production_index(Symbol const & nonterminal, Symbol const & terminal) const
+  {
+    auto const row = index_of(rows_, nonterminal);
+    if (row == no_index) {
+      return no_production;
+    }
+    auto const column = index_of(column_classes_, terminal);
+    if (column != no_index) {
+      auto const slot = static_cast<size_t>(displacements_[row]) + column;
+      if (slot < owners_.size() && owners_[slot] == row) {
+        return entries_[slot];
+      }
+    }
+    return defaults_[row];
+  }
+
+  Production const & production(Production_Index index) const { return productions_[index]; }
+  std::vector<Production> const & productions() const { return productions_; }
+
+  Parsing_Table_Footprint footprint() const;
+
+private:
+  static constexpr std::uint32_t no_index = Dense_Parsing_Table::no_index;
+
+  // Row and column class of each symbol, by id.
+  std::vector<std::uint32_t> rows_;
+  std::vector<std::uint32_t> column_classes_;
+  size_t column_class_count_;
+
+  // Where each row starts in the entries, and its default.
+  std::vector<std::uint32_t> displacements_;
+  std::vector<Production_Index> defaults_;
+
+  // The overlaid rows, and the row owning each slot.
+  std::vector<Production_Index> entries_;
+  std::vector<std::uint32_t> owners_;
+
+  std::vector<Production> productions_;
+
+  static std::uint32_t index_of(std::vector<std::uint32_t> const & indices, Symbol const & symbol)
+  {
+    return symbol.id() < indices.size() ? indices[symbol.id()] : no_index;
+  }
+};
+
+
+/**
+ * The production to expand `nonterminal` by when `terminal` is next, or null.
+ * The parse drivers look entries up through these, so work with either table.
+ */
+inline Production const *
+find_production(
+    Predictive_Parsing_Table const & table
+  , Symbol const & nonterminal
+  , Symbol const & terminal)
+{
+  auto const found = table.find(Symbol_Pair(nonterminal, terminal));
+  return found == table.end() ? nullptr : &found->second;
+}
+
+
+inline Production const *
+find_production(
+    Dense_Parsing_Table const & table
+  , Symbol const & nonterminal
+  , Symbol const & terminal)
+{
+  auto const index = table.production_index(nonterminal, terminal);
+  return index == Dense_Parsing_Table::no_production ? nullptr : &table.production(index);
+}
+
+
+inline Production const *
+find_production(
+    Compressed_Parsing_Table const & table
+  , Symbol const & nonterminal
+  , Symbol const & terminal)
+{
+  auto const index = table.production_index(nonterminal, terminal);
+  return index == Compressed_Parsing_Table::no_production ? nullptr : &table.production(index);
+}
+
+
 /**
  * A visitor to just print the production and symbols as they are processed.
  */
@@ -40,56 +275,63 @@ public:
 /**
  * Runs a simple predictive parser algorithm calling a visitor for every
  * terminal and production found.  No error handling is done.
+ *
+ * The tokens are read in a single pass, so may be a `Token_Range` which lexes
+ * each token only as the parser reaches it.  Each step looks up the table once,
+ * which takes constant time with a `Dense_Parsing_Table`.
+ *
+ * Only `start_symbol()` and `is_terminal()` are used of the grammar, so a
+ * `Static_Parsing_Table` can stand in for its own grammar.
  */
-template <typename IterableTokenType, typename VisitorFunctor>
+template <typename Parsing_Table, typename Parsing_Grammar, typename IterableTokenType, typename VisitorFunctor>
 void
 predictive_parse(
-    Predictive_Parsing_Table const & ppt
-  , Grammar const & grammar
+    Parsing_Table const & ppt
+  , Parsing_Grammar const & grammar
   , IterableTokenType & tokens
   , VisitorFunctor & visitor)
 {
   // Prepares starting stack as our program followed by "end of input".
   // Push the start symbol onto the stack followed by the right end marker ($)
-  auto stack = std::stack<typename IterableTokenType::value_type>();
-  stack.push(Token(Symbol::right_end_marker()));
-  stack.push(Token(grammar.start_symbol()));
+  // Only symbols are needed on the stack, so tokens are never copied.
+  auto stack = std::stack<Symbol, std::vector<Symbol>>();
+  stack.push(Symbol::right_end_marker());
+  stack.push(grammar.start_symbol());
 
 #define error(err) std::cerr << "Encountered Error:" #err "\n"; return;
 
   auto X = stack.top();
   auto next_token_it = tokens.begin();
 
-  while (X.symbol != Symbol::right_end_marker()) {
-    auto lookup = std::make_pair(X.symbol, next_token_it->symbol);
-
+  while (X != Symbol::right_end_marker()) {
     // Next input is terminal matching stack top.
-    if (X.symbol == next_token_it->symbol) {
-      X.lexeme = next_token_it->lexeme;
+    if (X == next_token_it->symbol) {
       visitor(next_token_it->symbol);
       stack.pop();
 
       // Go to next input.
       ++next_token_it;
+      X = stack.top();
+      continue;
     }
-    else if (grammar.is_terminal(X.symbol)) {
-      std::cout << "predictive_parse[error at unmapped terminal]" << X.symbol << std::endl;
-      error("Terminal!");
-    }
-    // if symbol not found, error
-    else if (ppt.count(lookup) == 0) {
+
+    auto const production = find_production(ppt, X, next_token_it->symbol);
+    if (production == nullptr) {
+      if (grammar.is_terminal(X)) {
+        std::cout << "predictive_parse[error at unmapped terminal]" << X << std::endl;
+        error("Terminal!");
+      }
+      // if symbol not found, error
       error("No production found");
     }
-    // if production
-    else if (ppt.count(lookup) > 0) {
-      visitor(ppt.at(lookup));
-      stack.pop();
 
-      // Push Yk, Y(k-1), Y(k-2), ... Y1
-      for (auto it = ppt.at(lookup).second.rbegin(); it != ppt.at(lookup).second.rend(); ++it) {
-        if (*it != Symbol::empty()) {
-          stack.push(Token {*it, ""});
-        }
+    visitor(*production);
+    stack.pop();
+
+    // Push Yk, Y(k-1), Y(k-2), ... Y1
+    for (auto it = production->second.rbegin(); it != production->second.rend(); ++it) {
+      if (*it != Symbol::empty()) {
+        stack.push(*it);
       }
     }
     X = stack.top();
@@ -99,12 +341,14 @@ predictive_parse(
 
 
 template <
-    typename Iterable_Token_Type
+    typename Parsing_Table
+  , typename Parsing_Grammar
+  , typename Iterable_Token_Type
   , typename Parse_Tree_Builder>
 auto
 predictive_parse_into_parse_tree(
-    Predictive_Parsing_Table const & ppt
-  , Grammar const & grammar
+    Parsing_Table const & ppt
+  , Parsing_Grammar const & grammar
   , Iterable_Token_Type & tokens
   , Parse_Tree_Builder & builder)
 -> typename Parse_Tree_Builder::value_type
@@ -123,8 +367,6 @@ predictive_parse_into_parse_tree(
 
   // Push the start symbol onto the stack followed by the right end marker ($)
   while (X->token().symbol != Symbol::right_end_marker()) {
-    auto lookup = std::make_pair(X->token().symbol, next_token_it->symbol);
-
     // Next input is terminal matching stack top.
     if (X->token().symbol == next_token_it->symbol) {
       X->set_lexeme(next_token_it->lexeme);
@@ -132,40 +374,42 @@ predictive_parse_into_parse_tree(
 
       // Go to next input.
       ++next_token_it;
+      X = stack.top();
+      continue;
     }
-    else if (grammar.is_terminal(X->token().symbol)) {
-      std::cerr << "predictive_parse[error at unmapped terminal]" << X->token().symbol << std::endl;
-      error("Terminal!");
-    }
-    // if symbol not found, error
-    else if (ppt.count(lookup) == 0) {
+
+    auto const production = find_production(ppt, X->token().symbol, next_token_it->symbol);
+    if (production == nullptr) {
+      if (grammar.is_terminal(X->token().symbol)) {
+        std::cerr << "predictive_parse[error at unmapped terminal]" << X->token().symbol << std::endl;
+        error("Terminal!");
+      }
+      // if symbol not found, error
       error("No production found");
     }
-    // if production
-    else if (ppt.count(lookup) > 0) {
-      stack.pop();
 
-      auto & body = ppt.at(lookup).second;
+    stack.pop();
+
+    auto & body = production->second;
 
-      // Push Yk, Y(k-1), Y(k-2), ... Y1
-      std::vector<typename Parse_Tree_Builder::value_type> children;
-      for (auto it = body.rbegin(); it != body.rend(); ++it) {
-        auto node = builder.create_node(Token(*it), X);
+    // Push Yk, Y(k-1), Y(k-2), ... Y1
+    std::vector<typename Parse_Tree_Builder::value_type> children(body.size());
+    for (size_t i = body.size(); i-- > 0;) {
+      auto node = builder.create_node(Token(body[i]), X);
 
-        // Insert into children at index 0 to undo reverse effects of pushing
-        // symbols in inverse order of the production.
-        children.insert(begin(children), node);
+      // Filled from the back to undo reverse effects of pushing symbols in
+      // inverse order of the production.
+      children[i] = node;
 
-        // Empty symbols cannot be production heads, so they don't need to be
-        // looked for.
-        if (*it != Symbol::empty()) {
-          stack.push(node);
-        }
+      // Empty symbols cannot be production heads, so they don't need to be
+      // looked for.
+      if (body[i] != Symbol::empty()) {
+        stack.push(node);
       }
-      // Setting all children at once provides a cleaner interface than
-      // setting individual ones.
-      X->set_children(children);
     }
+    // Setting all children at once provides a cleaner interface than
+    // setting individual ones.
+    X->set_children(children);
     X = stack.top();
   }
   return parse_tree_root;
@@ -52,6 +52,62 @@ TEST(Ambiguous_LL1_Grammar, Predictive_Parser_Table_Test) {
   ASSERT_FALSE(create_predictive_parsing_table(grammar, &parsing_table));
 }
 
+TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, Update_Predictive_Parser_Table_Test) {
+  Predictive_Parsing_Table parsing_table;
+  ASSERT_TRUE(create_predictive_parsing_table(grammar, &parsing_table));
+
+  // Adds unary minus and a power operator, changing rows of F and of the
+  // nonterminals which can end just before F.
+  auto changed = grammar.update_alternatives("F"_sym, {"("_sym + "E"_sym + ")"_sym | "id"_sym | "-"_sym + "F"_sym | "P"_sym});
+  auto const changed_by_p = grammar.update_alternatives("P"_sym, {"num"_sym + "^"_sym + "F"_sym});
+  changed.insert(changed_by_p.begin(), changed_by_p.end());
+  ASSERT_TRUE(update_predictive_parsing_table(grammar, changed, &parsing_table));
+  EXPECT_EQ(0u, changed.count("E'"_sym));
+
+  Grammar fresh;
+  for (auto const & head : {"E"_sym, "E'"_sym, "T"_sym, "T'"_sym, "F"_sym, "P"_sym}) {
+    fresh.set_alternatives(head, grammar[head]);
+  }
+  Predictive_Parsing_Table fresh_table;
+  ASSERT_TRUE(create_predictive_parsing_table(fresh, &fresh_table));
+  EXPECT_EQ(fresh_table, parsing_table);
+  EXPECT_EQ(parsing_table[Symbol_Pair("E"_sym, "-"_sym)], Production("E"_sym, {"T"_sym + "E'"_sym}));
+  EXPECT_EQ(parsing_table[Symbol_Pair("P"_sym, "num"_sym)], Production("P"_sym, {"num"_sym + "^"_sym + "F"_sym}));
+}
+
+TEST(Ambiguous_LL1_Grammar, Dense_Parsing_Table_Conflict) {
+  Grammar grammar;
+  grammar.set_alternatives("S"_sym, {"i"_sym + "E"_sym + "t"_sym + "S"_sym + "S'"_sym | "a"_sym});
+  grammar.set_alternatives("S'"_sym, {"e"_sym + "S"_sym | Symbol::empty()});
+  grammar.set_alternatives("E"_sym, {"b"_sym});
+
+  Dense_Parsing_Table parsing_table;
+  std::vector<Parsing_Table_Conflict> conflicts;
+  ASSERT_FALSE(create_dense_parsing_table(grammar, &parsing_table, &conflicts));
+  ASSERT_EQ(1u, conflicts.size());
+  EXPECT_EQ("S'"_sym, conflicts[0].nonterminal);
+  EXPECT_EQ("e"_sym, conflicts[0].terminal);
+  EXPECT_EQ(Production("S'"_sym, {"e"_sym + "S"_sym}), conflicts[0].chosen);
+  EXPECT_EQ(Production("S'"_sym, {Symbol::empty()}), conflicts[0].rejected);
+  EXPECT_EQ("[S',e] S' -> \"e S\" conflicts with S' -> \"empty\"", as_string(conflicts[0]));
+
+  // The table still holds the first production for each cell, so the usual
+  // resolution of the dangling else applies.
+  EXPECT_EQ(Production("S'"_sym, {"e"_sym + "S"_sym}), *find_production(parsing_table, "S'"_sym, "e"_sym));
+}
+
+TEST_F(Add_Multiply_Grammar_Test, Dense_Parsing_Table_Conflicts) {
+  // Every cell of the left recursive E and T has two productions.
+  Dense_Parsing_Table parsing_table;
+  std::vector<Parsing_Table_Conflict> conflicts;
+  ASSERT_FALSE(create_dense_parsing_table(grammar, &parsing_table, &conflicts));
+  ASSERT_EQ(4u, conflicts.size());
+  for (auto const & conflict : conflicts) {
+    EXPECT_TRUE(conflict.nonterminal == "E"_sym || conflict.nonterminal == "T"_sym);
+    EXPECT_TRUE(conflict.terminal == "("_sym || conflict.terminal == "id"_sym);
+  }
+}
+
 
 TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, Production_Printer_Test) {
   Predictive_Parsing_Table parsing_table;
@@ -144,6 +200,243 @@ TEST(Simple_List, Parse_Tree_Creation) {
 }
 
 
+TEST(Simple_List, Parse_Tree_From_Token_Views) {
+  Grammar simple_lisp;
+  simple_lisp.set_alternatives("s-exp"_sym, {"("_sym + "param_list"_sym + ")"_sym});
+  simple_lisp.set_alternatives("param_list"_sym,
+      "atom"_sym + "param_list"_sym
+      | "s-exp"_sym + "param_list"_sym
+      | Symbol::empty());
+
+  Predictive_Parsing_Table parsing_table;
+  ASSERT_TRUE(create_predictive_parsing_table(simple_lisp, &parsing_table));
+
+  Lexer lexer;
+  lexer.register_pattern_for_token("[(]", "(");
+  lexer.register_pattern_for_token("[)]", ")");
+  lexer.register_pattern_for_token("[a-zA-Z0-9+*/_-]+", "atom");
+
+  string const input = "(+ 1 2 (* 3 (- 5 6) 7))";
+  lexer.lex_borrowed(input.data(), input.size());
+
+  std::vector<Token_View> tokens;
+  while (lexer.has_next_token()) {
+    tokens.push_back(lexer.next_token_view());
+  }
+  tokens.push_back(Token_View(Symbol::right_end_marker(), Lexeme_View()));
+
+  Basic_Parse_Tree_Builder builder;
+  auto root = predictive_parse_into_parse_tree(parsing_table, simple_lisp, tokens, builder);
+  ASSERT_EQ(root->yield(), "( + 1 2 ( * 3 ( - 5 6 ) 7 ) )");
+}
+
+
+TEST(Simple_List, Parse_Tree_From_Lazy_Tokens) {
+  Grammar simple_lisp;
+  simple_lisp.set_alternatives("s-exp"_sym, {"("_sym + "param_list"_sym + ")"_sym});
+  simple_lisp.set_alternatives("param_list"_sym,
+      "atom"_sym + "param_list"_sym
+      | "s-exp"_sym + "param_list"_sym
+      | Symbol::empty());
+
+  Predictive_Parsing_Table parsing_table;
+  ASSERT_TRUE(create_predictive_parsing_table(simple_lisp, &parsing_table));
+
+  Lexer lexer;
+  lexer.register_pattern_for_token("[(]", "(");
+  lexer.register_pattern_for_token("[)]", ")");
+  lexer.register_pattern_for_token("[a-zA-Z0-9+*/_-]+", "atom");
+
+  lexer.lex("(+ 1 2 (* 3 (- 5 6) 7))");
+  auto tokens = token_range(lexer);
+  Basic_Parse_Tree_Builder builder;
+  auto root = predictive_parse_into_parse_tree(parsing_table, simple_lisp, tokens, builder);
+  ASSERT_EQ(root->yield(), "( + 1 2 ( * 3 ( - 5 6 ) 7 ) )");
+
+  // Straight from a stream, through a window smaller than the input.
+  stringstream input("(concat (first list) (rest list))");
+  Stream_Lexer stream(lexer, input, 8);
+  auto stream_tokens = token_range(stream);
+  root = predictive_parse_into_parse_tree(parsing_table, simple_lisp, stream_tokens, builder);
+  ASSERT_EQ(root->yield(), "( concat ( first list ) ( rest list ) )");
+}
+
+
+TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, Production_Printer_Lazy_Tokens) {
+  Predictive_Parsing_Table parsing_table;
+  ASSERT_TRUE(create_predictive_parsing_table(grammar, &parsing_table));
+
+  Lexer lexer;
+  lexer.register_pattern_for_token("[a-z]+", "id");
+  lexer.register_pattern_for_token("[+]", "+");
+  lexer.register_pattern_for_token("[*]", "*");
+  lexer.lex("a * b");
+
+  string expected = "E -> T E'\n"
+    "T -> F T'\n"
+    "F -> id\n"
+    "Matched: id\n"
+    "T' -> * F T'\n"
+    "Matched: *\n"
+    "F -> id\n"
+    "Matched: id\n"
+    "T' -> empty\n"
+    "E' -> empty\n";
+  stringstream parse_output;
+  Predictive_Parse_Print_Visitor printVisitor(parse_output);
+  auto tokens = token_range(lexer);
+  predictive_parse(parsing_table, grammar, tokens, printVisitor);
+  ASSERT_EQ(expected, parse_output.str());
+}
+
+
+TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, Dense_Parsing_Table_Test) {
+  Predictive_Parsing_Table parsing_table;
+  ASSERT_TRUE(create_predictive_parsing_table(grammar, &parsing_table));
+  Dense_Parsing_Table dense_table;
+  ASSERT_TRUE(create_dense_parsing_table(grammar, &dense_table));
+
+  // One row per nonterminal, a column per terminal (with $), and each of the
+  // 8 productions stored once, though most fill several cells.
+  EXPECT_EQ(5u, dense_table.row_count());
+  EXPECT_EQ(6u, dense_table.column_count());
+  EXPECT_EQ(8u, dense_table.productions().size());
+
+  for (auto const & head : {"E"_sym, "E'"_sym, "T"_sym, "T'"_sym, "F"_sym, "id"_sym, "unused"_sym}) {
+    for (auto const & terminal : {"id"_sym, "+"_sym, "*"_sym, "("_sym, ")"_sym, "$"_sym, "unused"_sym}) {
+      auto const expected = find_production(parsing_table, head, terminal);
+      auto const actual = find_production(dense_table, head, terminal);
+      ASSERT_EQ(expected == nullptr, actual == nullptr) << head << ", " << terminal;
+      if (expected != nullptr) {
+        EXPECT_EQ(*expected, *actual);
+      }
+    }
+  }
+}
+
+TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, Production_Printer_Dense_Table) {
+  Dense_Parsing_Table parsing_table;
+  ASSERT_TRUE(create_dense_parsing_table(grammar, &parsing_table));
+
+  std::vector<Token> tokens { Token("id"_sym, "a")
+    , Token("*"_sym)
+    , Token("("_sym)
+    , Token("id"_sym, "b")
+    , Token("+"_sym)
+    , Token("id"_sym, "c")
+    , Token(")"_sym)
+    , Token(Symbol::right_end_marker())};
+
+  string expected = "E -> T E'\n"
+    "T -> F T'\n"
+    "F -> id\n"
+    "Matched: id\n"
+    "T' -> * F T'\n"
+    "Matched: *\n"
+    "F -> ( E )\n"
+    "Matched: (\n"
+    "E -> T E'\n"
+    "T -> F T'\n"
+    "F -> id\n"
+    "Matched: id\n"
+    "T' -> empty\n"
+    "E' -> + T E'\n"
+    "Matched: +\n"
+    "T -> F T'\n"
+    "F -> id\n"
+    "Matched: id\n"
+    "T' -> empty\n"
+    "E' -> empty\n"
+    "Matched: )\n"
+    "T' -> empty\n"
+    "E' -> empty\n";
+  stringstream parse_output;
+  Predictive_Parse_Print_Visitor printVisitor(parse_output);
+  predictive_parse(parsing_table, grammar, tokens, printVisitor);
+  ASSERT_EQ(expected, parse_output.str());
+
+  Basic_Parse_Tree_Builder builder;
+  auto root = predictive_parse_into_parse_tree(parsing_table, grammar, tokens, builder);
+  ASSERT_EQ(root->yield(), "a * ( b + c )");
+}
+
+TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, Compressed_Parsing_Table_Test) {
+  Dense_Parsing_Table dense_table;
+  ASSERT_TRUE(create_dense_parsing_table(grammar, &dense_table));
+  Compressed_Parsing_Table exact_table(dense_table);
+  Compressed_Parsing_Table defaulting_table(dense_table, true);
+
+  for (auto const & head : {"E"_sym, "E'"_sym, "T"_sym, "T'"_sym, "F"_sym, "id"_sym, "unused"_sym}) {
+    for (auto const & terminal : {"id"_sym, "+"_sym, "*"_sym, "("_sym, ")"_sym, "$"_sym, "unused"_sym}) {
+      auto const expected = find_production(dense_table, head, terminal);
+      auto const exact = find_production(exact_table, head, terminal);
+      auto const defaulting = find_production(defaulting_table, head, terminal);
+      ASSERT_EQ(expected == nullptr, exact == nullptr) << head << ", " << terminal;
+      if (expected != nullptr) {
+        EXPECT_EQ(*expected, *exact);
+        ASSERT_NE(nullptr, defaulting);
+        EXPECT_EQ(*expected, *defaulting);
+      }
+    }
+  }
+
+  // Columns ) and $ are the same in every row.  With defaults, each row keeps
+  // at most one entry, so the rows overlay within the width of one row.
+  EXPECT_EQ(5u, exact_table.footprint().columns);
+  EXPECT_LE(defaulting_table.footprint().entries, 5u);
+  EXPECT_LT(exact_table.footprint().entries, dense_table.footprint().entries);
+  EXPECT_LT(defaulting_table.footprint().bytes, dense_table.footprint().bytes);
+
+  std::vector<Token> tokens { Token("id"_sym, "a")
+    , Token("*"_sym)
+    , Token("id"_sym, "b")
+    , Token("+"_sym)
+    , Token("id"_sym, "c")
+    , Token(Symbol::right_end_marker())};
+  Basic_Parse_Tree_Builder builder;
+  EXPECT_EQ("a * b + c", predictive_parse_into_parse_tree(exact_table, grammar, tokens, builder)->yield());
+  EXPECT_EQ("a * b + c", predictive_parse_into_parse_tree(defaulting_table, grammar, tokens, builder)->yield());
+}
+
+TEST(Compressed_Parsing_Table, Sparse_Rows_Share_Entries) {
+  // Each of many statement kinds starts with its own keyword.  The columns of
+  // the terminals after the keywords are all empty, so merge, and the rows of
+  // the statement kinds have one entry each, which fit between the others.
+  Grammar grammar;
+  Symbol_String_Alternatives statements;
+  for (size_t i = 0; i < 50; ++i) {
+    auto const kind = Symbol("statement" + std::to_string(i));
+    statements.push_back({kind});
+    grammar.set_alternatives(kind, {Symbol("keyword" + std::to_string(i)) + Symbol("body" + std::to_string(i))});
+  }
+  grammar.set_alternatives("statement"_sym, statements);
+  Grammar program;
+  program.set_alternatives("program"_sym, {"statement"_sym + "program"_sym | Symbol::empty()});
+  for (auto const & production : grammar.productions()) {
+    program.set_alternatives(production.first, production.second);
+  }
+
+  Dense_Parsing_Table dense_table;
+  ASSERT_TRUE(create_dense_parsing_table(program, &dense_table));
+  Compressed_Parsing_Table compressed_table(dense_table);
+  auto const dense = dense_table.footprint();
+  auto const compressed = compressed_table.footprint();
+  EXPECT_EQ(52u * 101u, dense.entries);
+  EXPECT_LE(compressed.entries, 52u + 51u + 50u);
+  EXPECT_LT(compressed.bytes * 5, dense.bytes);
+  EXPECT_EQ("52 rows, 52 columns, " + std::to_string(compressed.entries) + " entries, "
+    + std::to_string(compressed.bytes) + " bytes", as_string(compressed));
+
+  for (size_t i = 0; i < 50; ++i) {
+    auto const keyword = Symbol("keyword" + std::to_string(i));
+    auto const kind = Symbol("statement" + std::to_string(i));
+    ASSERT_NE(nullptr, find_production(compressed_table, "statement"_sym, keyword));
+    EXPECT_EQ(Symbol_String({kind}), find_production(compressed_table, "statement"_sym, keyword)->second);
+    EXPECT_EQ(nullptr, find_production(compressed_table, kind, "$"_sym));
+    EXPECT_EQ(nullptr, find_production(compressed_table, kind, Symbol("keyword" + std::to_string((i + 1) % 50))));
+  }
+}
+
 int main(int argc, char ** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
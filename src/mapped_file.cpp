@@ -0,0 +1,154 @@
+#include "mapped_file.hpp"
+
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PARKA_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace parka {
+
+#if PARKA_HAS_MMAP
+
+Mapped_File::Mapped_File(string const & path)
+  : data_(nullptr)
+  , size_(0)
+  , is_mapped_(false)
+{
+  auto const fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "Unable to open " + path);
+  }
+
+  struct stat status;
+  if (::fstat(fd, &status) != 0) {
+    auto const error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), "Unable to stat " + path);
+  }
+
+  // Pipes, devices and the like have no size to map, and files which report
+  // none (such as those under /proc) may still have contents, so only regular
+  // files with a size are mapped and everything else is read in.  Zero length
+  // mappings are not allowed anyways.
+  if (!S_ISREG(status.st_mode) || status.st_size == 0) {
+    char_type buffer[1 << 16];
+    for (;;) {
+      auto const count = ::read(fd, buffer, sizeof(buffer));
+      if (count == 0) {
+        break;
+      }
+      if (count < 0) {
+        auto const error = errno;
+        if (error == EINTR) {
+          continue;
+        }
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "Unable to read " + path);
+      }
+      contents_.append(buffer, static_cast<size_t>(count));
+    }
+    ::close(fd);
+    data_ = contents_.data();
+    size_ = contents_.size();
+    return;
+  }
+
+  size_ = static_cast<size_t>(status.st_size);
+  auto const mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapping == MAP_FAILED) {
+    auto const error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), "Unable to map " + path);
+  }
+  ::madvise(mapping, size_, MADV_SEQUENTIAL);
+  data_ = static_cast<char_type const *>(mapping);
+  is_mapped_ = true;
+
+  // The mapping stays valid after the file is closed.
+  ::close(fd);
+}
+
+
+void
+Mapped_File::release()
+{
+  if (is_mapped_) {
+    ::munmap(const_cast<char_type *>(data_), size_);
+  }
+}
+
+#else
+
+Mapped_File::Mapped_File(string const & path)
+  : data_(nullptr)
+  , size_(0)
+  , is_mapped_(false)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw std::system_error(errno, std::generic_category(), "Unable to open " + path);
+  }
+  contents_.assign(std::istreambuf_iterator<char_type>(file), std::istreambuf_iterator<char_type>());
+  data_ = contents_.data();
+  size_ = contents_.size();
+}
+
+
+void
+Mapped_File::release()
+{
+}
+
+#endif
+
+
+Mapped_File::~Mapped_File()
+{
+  release();
+}
+
+
+Mapped_File::Mapped_File(Mapped_File && other)
+  : data_(other.data_)
+  , size_(other.size_)
+  , is_mapped_(other.is_mapped_)
+  , contents_(std::move(other.contents_))
+{
+  if (!is_mapped_) {
+    data_ = contents_.data();
+  }
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.is_mapped_ = false;
+}
+
+
+Mapped_File &
+Mapped_File::operator=(Mapped_File && other)
+{
+  if (this != &other) {
+    release();
+    data_ = other.data_;
+    size_ = other.size_;
+    is_mapped_ = other.is_mapped_;
+    contents_ = std::move(other.contents_);
+    if (!is_mapped_) {
+      data_ = contents_.data();
+    }
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.is_mapped_ = false;
+  }
+  return *this;
+}
+
+} // namespace parka
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "string.hpp"
+
+#include <cstddef>
+
+namespace parka {
+
+/**
+ * A read-only view of a whole file, mapped into memory where the platform
+ * supports it so the file is never copied, otherwise read in.  Files which are
+ * not regular files, such as pipes and devices, or which report a size of
+ * zero, such as those under /proc, are always read in.  Mapped files are
+ * advised to be read sequentially, as a lexer does.
+ *
+ * Throws `std::system_error` if the file cannot be opened, read or mapped.
+ */
+class Mapped_File {
+  char_type const * data_;
+  size_t size_;
+  bool is_mapped_;
+  string contents_;
+
+  void release();
+
+public:
+  explicit Mapped_File(string const & path);
+  ~Mapped_File();
+
+  // Owns the mapping, so can be moved but not copied.
+  Mapped_File(Mapped_File const &) = delete;
+  Mapped_File & operator=(Mapped_File const &) = delete;
+  Mapped_File(Mapped_File && other);
+  Mapped_File & operator=(Mapped_File && other);
+
+  char_type const * data() const { return data_; }
+  size_t size() const { return size_; }
+  bool is_mapped() const { return is_mapped_; }
+};
+
+} // namespace parka
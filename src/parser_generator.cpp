@@ -0,0 +1,405 @@
+#include "parser_generator.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace parka {
+
+namespace {
+
+bool
+by_name(Symbol const & lhs, Symbol const & rhs)
+{
+  return lhs.repr() < rhs.repr();
+}
+
+
+/**
+ * `name` as a C++ string literal.  Other control characters are written as
+ * three digit octal escapes, so a following digit can't extend them.
+ */
+string
+quoted(string const & name)
+{
+  static char const digits[] = "01234567";
+  string result = "\"";
+  for (auto const c : name) {
+    auto const byte = static_cast<unsigned char>(c);
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += c;
+    } else if (byte < 0x20 || byte == 0x7F) {
+      result += '\\';
+      result += digits[(byte >> 6) & 7];
+      result += digits[(byte >> 3) & 7];
+      result += digits[byte & 7];
+    } else {
+      result += c;
+    }
+  }
+  return result + '"';
+}
+
+
+/**
+ * Code constructing `symbol` in the generated parser.
+ */
+string
+symbol_code(Symbol const & symbol)
+{
+  return symbol == Symbol::empty() ? "parka::Symbol::empty()" : "parka::Symbol(" + quoted(symbol.repr()) + ')';
+}
+
+
+/**
+ * An alternative which the table chooses for at least one terminal.
+ */
+struct Table_Alternative {
+  Symbol_String const * body;
+  size_t production;
+  vector<size_t> terminals;
+};
+
+
+/**
+ * Symbols of the grammar numbered in order of name, and the alternatives of
+ * each nonterminal the table can choose, numbered as productions.
+ */
+class Generated_Parser_Layout {
+public:
+  vector<Symbol> nonterminals;
+  vector<Symbol> terminals;
+  vector<vector<Table_Alternative>> alternatives;
+  size_t production_count;
+
+  Generated_Parser_Layout(Grammar const & grammar, Predictive_Parsing_Table const & parsing_table)
+    : production_count(0)
+  {
+    auto const & productions = grammar.productions();
+    Symbol_Set terminal_set {Symbol::right_end_marker()};
+    for (auto const & entry : productions) {
+      nonterminals.push_back(entry.first);
+      for (auto const & body : entry.second) {
+        for (auto const & symbol : body) {
+          if (symbol != Symbol::empty() && productions.count(symbol) == 0) {
+            terminal_set.insert(symbol);
+          }
+        }
+      }
+    }
+    for (auto const & cell : parsing_table) {
+      terminal_set.insert(cell.first.second);
+    }
+    terminals.assign(terminal_set.begin(), terminal_set.end());
+    std::sort(nonterminals.begin(), nonterminals.end(), by_name);
+    std::sort(terminals.begin(), terminals.end(), by_name);
+
+    alternatives.resize(nonterminals.size());
+    for (size_t n = 0; n < nonterminals.size(); ++n) {
+      for (auto const & body : productions.at(nonterminals[n])) {
+        Table_Alternative alternative {&body, production_count, {}};
+        for (size_t t = 0; t < terminals.size(); ++t) {
+          auto const found = parsing_table.find(Symbol_Pair(nonterminals[n], terminals[t]));
+          if (found != parsing_table.end() && found->second.second == body) {
+            alternative.terminals.push_back(t);
+          }
+        }
+        if (!alternative.terminals.empty()) {
+          alternatives[n].push_back(std::move(alternative));
+          ++production_count;
+        }
+      }
+    }
+  }
+
+  size_t nonterminal_index(Symbol const & symbol) const
+  {
+    return static_cast<size_t>(std::lower_bound(nonterminals.begin(), nonterminals.end(), symbol, by_name) - nonterminals.begin());
+  }
+
+  size_t terminal_index(Symbol const & symbol) const
+  {
+    return static_cast<size_t>(std::lower_bound(terminals.begin(), terminals.end(), symbol, by_name) - terminals.begin());
+  }
+
+  bool is_nonterminal(Symbol const & symbol) const
+  {
+    return std::binary_search(nonterminals.begin(), nonterminals.end(), symbol, by_name);
+  }
+};
+
+
+void
+write_case_labels(ostream & os, Generated_Parser_Layout const & layout, Table_Alternative const & alternative, bool opens_block)
+{
+  for (size_t i = 0; i < alternative.terminals.size(); ++i) {
+    auto const t = alternative.terminals[i];
+    auto const last = i + 1 == alternative.terminals.size();
+    os << "      case terminal_" << t << ":" << (last && opens_block ? " {" : "")
+       << "  // " << quoted(layout.terminals[t].repr()) << '\n';
+  }
+}
+
+
+/**
+ * Writes the calls parsing each symbol of a body in turn, chained with `&&`.
+ * `call` gives the call for the symbol at an index of the body.
+ */
+template <typename Call>
+void
+write_body_calls(ostream & os, Symbol_String const & body, Call call)
+{
+  vector<string> calls;
+  for (size_t i = 0; i < body.size(); ++i) {
+    if (body[i] != Symbol::empty()) {
+      calls.push_back(call(i));
+    }
+  }
+  if (calls.empty()) {
+    os << "        return true;\n";
+    return;
+  }
+  for (size_t i = 0; i < calls.size(); ++i) {
+    os << (i == 0 ? "        return " : "\n          && ") << calls[i];
+  }
+  os << ";\n";
+}
+
+
+void
+write_visiting_function(ostream & os, Generated_Parser_Layout const & layout, size_t n)
+{
+  os << "  // " << quoted(layout.nonterminals[n].repr()) << '\n'
+     << "  template <typename Iterator, typename Visitor_Functor>\n"
+     << "  static bool\n"
+     << "  parse_" << n << "(Iterator & it, Visitor_Functor & visitor)\n"
+     << "  {\n"
+     << "    switch (terminal_of(it->symbol)) {\n";
+  for (auto const & alternative : layout.alternatives[n]) {
+    auto const & body = *alternative.body;
+    write_case_labels(os, layout, alternative, false);
+    os << "        visitor(production(" << alternative.production << "));\n";
+    write_body_calls(os, body, [&](size_t i) {
+      return layout.is_nonterminal(body[i])
+        ? "parse_" + std::to_string(layout.nonterminal_index(body[i])) + "(it, visitor)"
+        : "match(it, visitor, terminal_" + std::to_string(layout.terminal_index(body[i])) + ")";
+    });
+  }
+  os << "      default:\n"
+     << "        return false;\n"
+     << "    }\n"
+     << "  }\n";
+}
+
+
+void
+write_building_function(ostream & os, Generated_Parser_Layout const & layout, size_t n)
+{
+  os << "  // " << quoted(layout.nonterminals[n].repr()) << '\n'
+     << "  template <typename Iterator, typename Parse_Tree_Builder>\n"
+     << "  static bool\n"
+     << "  build_" << n << "(Iterator & it, Parse_Tree_Builder & builder, typename Parse_Tree_Builder::value_type const & node)\n"
+     << "  {\n"
+     << "    switch (terminal_of(it->symbol)) {\n";
+  for (auto const & alternative : layout.alternatives[n]) {
+    auto const & body = *alternative.body;
+    auto const only_empty = std::all_of(body.begin(), body.end(), [](Symbol const & symbol) {
+      return symbol == Symbol::empty();
+    });
+    if (only_empty) {
+      write_case_labels(os, layout, alternative, false);
+      os << "        expand(builder, node, production(" << alternative.production << "));\n"
+         << "        return true;\n";
+      continue;
+    }
+    write_case_labels(os, layout, alternative, true);
+    os << "        auto const children = expand(builder, node, production(" << alternative.production << "));\n";
+    write_body_calls(os, body, [&](size_t i) {
+      auto const child = "children[" + std::to_string(i) + "]";
+      return layout.is_nonterminal(body[i])
+        ? "build_" + std::to_string(layout.nonterminal_index(body[i])) + "(it, builder, " + child + ")"
+        : "match_into(it, " + child + ", terminal_" + std::to_string(layout.terminal_index(body[i])) + ")";
+    });
+    os << "      }\n";
+  }
+  os << "      default:\n"
+     << "        return false;\n"
+     << "    }\n"
+     << "  }\n";
+}
+
+} // namespace
+
+
+bool
+generate_recursive_descent_parser(
+    Grammar const & grammar
+  , Predictive_Parsing_Table const & parsing_table
+  , string const & class_name
+  , ostream & os)
+{
+  auto const start = grammar.start_symbol();
+  if (grammar.productions().count(start) == 0) {
+    return false;
+  }
+
+  Generated_Parser_Layout const layout(grammar, parsing_table);
+  auto const start_index = layout.nonterminal_index(start);
+  auto const end_index = layout.terminal_index(Symbol::right_end_marker());
+
+  os << "// Generated by parka::generate_recursive_descent_parser.  Edit the grammar\n"
+     << "// it was generated from and regenerate it, rather than editing this file.\n"
+     << "#pragma once\n"
+     << "\n"
+     << "#include \"grammar.hpp\"\n"
+     << "#include \"parse_tree.hpp\"\n"
+     << "#include \"symbol.hpp\"\n"
+     << "#include \"token.hpp\"\n"
+     << "\n"
+     << "#include <vector>\n"
+     << "\n"
+     << "/**\n"
+     << " * Recursive-descent parser for the grammar with the start symbol "
+     << quoted(start.repr()) << ".\n"
+     << " */\n"
+     << "class " << class_name << " {\n"
+     << "public:\n"
+     << "  /**\n"
+     << "   * Calls `visitor` for every terminal and production found while parsing\n"
+     << "   * `tokens`, as `parka::predictive_parse` does.  Returns whether all of the\n"
+     << "   * input up to the right end marker was parsed.\n"
+     << "   */\n"
+     << "  template <typename Iterable_Token_Type, typename Visitor_Functor>\n"
+     << "  static bool\n"
+     << "  parse(Iterable_Token_Type & tokens, Visitor_Functor & visitor)\n"
+     << "  {\n"
+     << "    auto it = tokens.begin();\n"
+     << "    return parse_" << start_index << "(it, visitor) && terminal_of(it->symbol) == terminal_" << end_index << ";\n"
+     << "  }\n"
+     << "\n"
+     << "  /**\n"
+     << "   * Builds the parse tree of `tokens`, as\n"
+     << "   * `parka::predictive_parse_into_parse_tree` does.  Returns null if not all\n"
+     << "   * of the input up to the right end marker could be parsed.\n"
+     << "   */\n"
+     << "  template <typename Iterable_Token_Type, typename Parse_Tree_Builder>\n"
+     << "  static auto\n"
+     << "  parse_into_parse_tree(Iterable_Token_Type & tokens, Parse_Tree_Builder & builder)\n"
+     << "  -> typename Parse_Tree_Builder::value_type\n"
+     << "  {\n"
+     << "    auto it = tokens.begin();\n"
+     << "    auto root = builder.create_node(parka::Token(" << symbol_code(start) << "));\n"
+     << "    if (!build_" << start_index << "(it, builder, root) || terminal_of(it->symbol) != terminal_" << end_index << ") {\n"
+     << "      return nullptr;\n"
+     << "    }\n"
+     << "    return root;\n"
+     << "  }\n"
+     << "\n"
+     << "private:\n"
+     << "  enum Terminal : unsigned {\n";
+  for (size_t t = 0; t < layout.terminals.size(); ++t) {
+    os << "    terminal_" << t << ",  // " << quoted(layout.terminals[t].repr()) << '\n';
+  }
+  os << "    no_terminal\n"
+     << "  };\n"
+     << "\n"
+     << "  /**\n"
+     << "   * The number of the terminal `symbol` is, which the switches use.  Symbol\n"
+     << "   * ids depend on the order names were interned in, so are mapped to these\n"
+     << "   * numbers on first use.\n"
+     << "   */\n"
+     << "  static Terminal\n"
+     << "  terminal_of(parka::Symbol const & symbol)\n"
+     << "  {\n"
+     << "    static std::vector<Terminal> const terminals = [] {\n"
+     << "      char const * const names[] = {\n";
+  for (auto const & terminal : layout.terminals) {
+    os << "        " << quoted(terminal.repr()) << ",\n";
+  }
+  os << "      };\n"
+     << "      std::vector<Terminal> result;\n"
+     << "      for (unsigned i = 0; i < no_terminal; ++i) {\n"
+     << "        auto const id = parka::Symbol(names[i]).id();\n"
+     << "        if (id >= result.size()) {\n"
+     << "          result.resize(id + 1, no_terminal);\n"
+     << "        }\n"
+     << "        result[id] = static_cast<Terminal>(i);\n"
+     << "      }\n"
+     << "      return result;\n"
+     << "    }();\n"
+     << "    return symbol.id() < terminals.size() ? terminals[symbol.id()] : no_terminal;\n"
+     << "  }\n"
+     << "\n"
+     << "  static parka::Production const &\n"
+     << "  production(unsigned index)\n"
+     << "  {\n"
+     << "    static std::vector<parka::Production> const productions {\n";
+  for (size_t n = 0; n < layout.nonterminals.size(); ++n) {
+    for (auto const & alternative : layout.alternatives[n]) {
+      os << "      {" << symbol_code(layout.nonterminals[n]) << ", {";
+      auto const & body = *alternative.body;
+      for (size_t i = 0; i < body.size(); ++i) {
+        os << (i == 0 ? "" : ", ") << symbol_code(body[i]);
+      }
+      os << "}},\n";
+    }
+  }
+  os << "    };\n"
+     << "    return productions[index];\n"
+     << "  }\n"
+     << "\n"
+     << "  template <typename Iterator, typename Visitor_Functor>\n"
+     << "  static bool\n"
+     << "  match(Iterator & it, Visitor_Functor & visitor, Terminal terminal)\n"
+     << "  {\n"
+     << "    if (terminal_of(it->symbol) != terminal) {\n"
+     << "      return false;\n"
+     << "    }\n"
+     << "    visitor(it->symbol);\n"
+     << "    ++it;\n"
+     << "    return true;\n"
+     << "  }\n"
+     << "\n"
+     << "  template <typename Iterator, typename Node>\n"
+     << "  static bool\n"
+     << "  match_into(Iterator & it, Node const & node, Terminal terminal)\n"
+     << "  {\n"
+     << "    if (terminal_of(it->symbol) != terminal) {\n"
+     << "      return false;\n"
+     << "    }\n"
+     << "    node->set_lexeme(it->lexeme);\n"
+     << "    ++it;\n"
+     << "    return true;\n"
+     << "  }\n"
+     << "\n"
+     << "  /**\n"
+     << "   * Gives `node` a child for each symbol of the body of `production`.\n"
+     << "   */\n"
+     << "  template <typename Parse_Tree_Builder>\n"
+     << "  static std::vector<typename Parse_Tree_Builder::value_type>\n"
+     << "  expand(\n"
+     << "      Parse_Tree_Builder & builder\n"
+     << "    , typename Parse_Tree_Builder::value_type const & node\n"
+     << "    , parka::Production const & production)\n"
+     << "  {\n"
+     << "    std::vector<typename Parse_Tree_Builder::value_type> children;\n"
+     << "    children.reserve(production.second.size());\n"
+     << "    for (auto const & symbol : production.second) {\n"
+     << "      children.push_back(builder.create_node(parka::Token(symbol), node));\n"
+     << "    }\n"
+     << "    node->set_children(children);\n"
+     << "    return children;\n"
+     << "  }\n";
+  for (size_t n = 0; n < layout.nonterminals.size(); ++n) {
+    os << '\n';
+    write_visiting_function(os, layout, n);
+  }
+  for (size_t n = 0; n < layout.nonterminals.size(); ++n) {
+    os << '\n';
+    write_building_function(os, layout, n);
+  }
+  os << "};\n";
+  return true;
+}
+
+} // namespace parka
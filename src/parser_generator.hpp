@@ -0,0 +1,32 @@
+#pragma once
+
+#include "grammar.hpp"
+#include "ll.hpp"
+#include "streams.hpp"
+#include "string.hpp"
+
+namespace parka {
+
+/**
+ * Writes the C++ source of a recursive-descent parser for `grammar` to `os`,
+ * as a header defining the class `class_name`.  Each nonterminal gets its own
+ * function, which picks the production to expand by a `switch` on the
+ * lookahead terminal, so parsing no longer interprets `parsing_table`.
+ *
+ * The generated class has static `parse` and `parse_into_parse_tree` members,
+ * which take tokens and a visitor or parse tree builder just as
+ * `predictive_parse` and `predictive_parse_into_parse_tree` do, and give the
+ * same results.  They only use the grammar, symbol, token and parse tree
+ * headers.
+ *
+ * Symbols are written by name and sorted by name, so the same grammar always
+ * gives the same source.  Returns false, writing nothing, if the start symbol
+ * of `grammar` has no productions.
+ */
+bool generate_recursive_descent_parser(
+    Grammar const & grammar
+  , Predictive_Parsing_Table const & parsing_table
+  , string const & class_name
+  , ostream & os);
+
+} // namespace parka
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include "add_multiply_parser.hpp"
+#include "grammar.hpp"
+#include "ll.hpp"
+#include "parse_tree.hpp"
+#include "parser_generator.hpp"
+#include "streams.hpp"
+#include "string.hpp"
+#include "symbol.hpp"
+using namespace parka;
+
+#include "sample_grammar_test_fixtures.hpp"
+
+#include <fstream>
+#include <regex>
+
+
+/**
+ * Tokens for each symbol of `symbols`, with a lexeme numbering it, followed by
+ * the right end marker.
+ */
+static std::vector<Token>
+tokens_of(Symbol_String const & symbols)
+{
+  std::vector<Token> tokens;
+  for (auto const & symbol : symbols) {
+    tokens.emplace_back(symbol, symbol.repr() + std::to_string(tokens.size()));
+  }
+  tokens.emplace_back(Symbol::right_end_marker());
+  return tokens;
+}
+
+
+/**
+ * The printed parse tree without its node IDs, which differ between trees.
+ */
+static string
+printed_without_ids(std::shared_ptr<Parse_Tree_Node> const & root)
+{
+  stringstream printed;
+  root->print(printed);
+  return std::regex_replace(printed.str(), std::regex("  ID=[0-9]+"), "");
+}
+
+
+TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, Checked_In_Parser_Is_Current) {
+  Predictive_Parsing_Table parsing_table;
+  ASSERT_TRUE(create_predictive_parsing_table(grammar, &parsing_table));
+
+  stringstream generated;
+  ASSERT_TRUE(generate_recursive_descent_parser(grammar, parsing_table, "Add_Multiply_Parser", generated));
+
+  auto const source = string(__FILE__);
+  std::ifstream file(source.substr(0, source.find_last_of("/\\") + 1) + "add_multiply_parser.hpp");
+  ASSERT_TRUE(file.good()) << "add_multiply_parser.hpp not found next to " << source;
+  stringstream checked_in;
+  checked_in << file.rdbuf();
+  EXPECT_EQ(generated.str(), checked_in.str()) << "Run the regenerate_parsers target";
+}
+
+
+TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, Generated_Parser_Matches_Table) {
+  Predictive_Parsing_Table parsing_table;
+  ASSERT_TRUE(create_predictive_parsing_table(grammar, &parsing_table));
+
+  auto const id = "id"_sym, plus = "+"_sym, times = "*"_sym, open = "("_sym, close = ")"_sym;
+  std::vector<Symbol_String> const inputs {
+    {id},
+    {id, plus, id, times, id},
+    {open, id, plus, id, close, times, id},
+    {open, open, id, close, close, times, open, id, times, id, plus, id, close},
+  };
+
+  for (auto const & input : inputs) {
+    auto tokens = tokens_of(input);
+
+    stringstream table_output;
+    Predictive_Parse_Print_Visitor table_visitor(table_output);
+    predictive_parse(parsing_table, grammar, tokens, table_visitor);
+
+    stringstream generated_output;
+    Predictive_Parse_Print_Visitor generated_visitor(generated_output);
+    EXPECT_TRUE(Add_Multiply_Parser::parse(tokens, generated_visitor)) << input;
+    EXPECT_EQ(table_output.str(), generated_output.str()) << input;
+
+    Basic_Parse_Tree_Builder builder;
+    auto const table_tree = predictive_parse_into_parse_tree(parsing_table, grammar, tokens, builder);
+    auto const generated_tree = Add_Multiply_Parser::parse_into_parse_tree(tokens, builder);
+    ASSERT_NE(nullptr, table_tree);
+    ASSERT_NE(nullptr, generated_tree);
+    EXPECT_EQ(table_tree->yield(), generated_tree->yield()) << input;
+    EXPECT_EQ(printed_without_ids(table_tree), printed_without_ids(generated_tree)) << input;
+  }
+}
+
+
+TEST(Generated_Parser, Rejects_Invalid_Input) {
+  auto const id = "id"_sym, plus = "+"_sym, open = "("_sym, close = ")"_sym;
+  std::vector<Symbol_String> const inputs {
+    {},
+    {plus},
+    {id, plus},
+    {open, id},
+    {id, close},
+    {id, id},
+  };
+
+  for (auto const & input : inputs) {
+    auto tokens = tokens_of(input);
+    stringstream output;
+    Predictive_Parse_Print_Visitor visitor(output);
+    EXPECT_FALSE(Add_Multiply_Parser::parse(tokens, visitor)) << input;
+
+    Basic_Parse_Tree_Builder builder;
+    EXPECT_EQ(nullptr, Add_Multiply_Parser::parse_into_parse_tree(tokens, builder)) << input;
+  }
+}
+
+
+TEST(Generated_Parser, Names_Are_Quoted) {
+  Grammar grammar;
+  grammar.set_alternatives("list"_sym, {"\"x\\"_sym + "list"_sym | Symbol::empty()});
+
+  Predictive_Parsing_Table parsing_table;
+  ASSERT_TRUE(create_predictive_parsing_table(grammar, &parsing_table));
+
+  stringstream generated;
+  ASSERT_TRUE(generate_recursive_descent_parser(grammar, parsing_table, "List_Parser", generated));
+  EXPECT_NE(string::npos, generated.str().find("class List_Parser {"));
+  EXPECT_NE(string::npos, generated.str().find("parka::Symbol(\"\\\"x\\\\\")"));
+}
+
+
+TEST(Generated_Parser, Start_Symbol_Without_Productions) {
+  Grammar grammar;
+  stringstream generated;
+  EXPECT_FALSE(generate_recursive_descent_parser(grammar, Predictive_Parsing_Table(), "Empty_Parser", generated));
+  EXPECT_TRUE(generated.str().empty());
+}
+
+int main(int argc, char ** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "add_multiply_grammar.hpp"
 #include "grammar.hpp"
 #include "streams.hpp"
 #include "symbol.hpp"
@@ -32,11 +33,7 @@ protected:
   parka::Grammar grammar;
 
   virtual void SetUp() {
-    grammar.set_alternatives("E"_sym, {"T"_sym + "E'"_sym});
-    grammar.set_alternatives("E'"_sym, {"+"_sym + "T"_sym + "E'"_sym | Symbol::empty()});
-    grammar.set_alternatives("T"_sym, {"F"_sym + "T'"_sym});
-    grammar.set_alternatives("T'"_sym, {"*"_sym + "F"_sym + "T'"_sym | Symbol::empty()});
-    grammar.set_alternatives("F"_sym, {"("_sym + "E"_sym + ")"_sym | "id"_sym});
+    parka::set_non_left_recursive_add_multiply_alternatives(grammar);
   }
 
   virtual void TearDown() {}
@@ -0,0 +1,1044 @@
+#include "scanner.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <set>
+#include <tuple>
+#include <utility>
+
+namespace parka {
+
+constexpr size_t Pattern_Node::unbounded;
+constexpr size_t Scanner::no_match;
+constexpr Scanner::State Scanner::dead_state;
+
+namespace {
+
+// Repetition counts beyond this are expanded into too many NFA states to be
+// worth compiling, so are left to std::regex.
+constexpr size_t max_repetition_count = 256;
+
+// Upper limit on the DFA size before giving up on compilation.
+constexpr size_t max_dfa_states = 1 << 16;
+
+
+Byte_Set
+byte_range(unsigned char first, unsigned char last)
+{
+  Byte_Set result;
+  for (auto byte = static_cast<size_t>(first); byte <= last; ++byte) {
+    result.set(byte);
+  }
+  return result;
+}
+
+
+Byte_Set
+word_bytes()
+{
+  return byte_range('a', 'z') | byte_range('A', 'Z') | byte_range('0', '9') | byte_range('_', '_');
+}
+
+
+unsigned char
+lowest_byte(Byte_Set const & bytes)
+{
+  for (size_t byte = 0; byte < 256; ++byte) {
+    if (bytes.test(byte)) {
+      return static_cast<unsigned char>(byte);
+    }
+  }
+  return 0;
+}
+
+
+bool
+is_word_byte(char_type ch)
+{
+  static Byte_Set const word = word_bytes();
+  return word.test(static_cast<unsigned char>(ch));
+}
+
+
+/**
+ * Recursive descent parser for ECMAScript regular expressions.  Rather than
+ * report errors (std::regex has already done so), it flags the first feature
+ * it cannot convert into an automaton and gives up.
+ */
+class Pattern_Parser {
+  string const & expression_;
+  size_t position_;
+  bool supported_;
+
+public:
+  explicit Pattern_Parser(string const & expression)
+    : expression_(expression)
+    , position_(0)
+    , supported_(true)
+  {
+  }
+
+  bool parse(Pattern_Node * root)
+  {
+    *root = parse_alternation();
+    return supported_ && at_end();
+  }
+
+private:
+  bool at_end() const { return position_ >= expression_.size(); }
+  char_type peek() const { return at_end() ? '\0' : expression_[position_]; }
+  char_type next() { return at_end() ? '\0' : expression_[position_++]; }
+
+  Pattern_Node unsupported()
+  {
+    supported_ = false;
+    position_ = expression_.size();
+    return Pattern_Node();
+  }
+
+  Pattern_Node parse_alternation()
+  {
+    Pattern_Node result;
+    result.kind = Pattern_Node::Kind::alternation;
+    result.children.push_back(parse_concatenation());
+    while (supported_ && peek() == '|') {
+      next();
+      result.children.push_back(parse_concatenation());
+    }
+    if (result.children.size() == 1) {
+      return result.children.front();
+    }
+    return result;
+  }
+
+  Pattern_Node parse_concatenation()
+  {
+    Pattern_Node result;
+    result.kind = Pattern_Node::Kind::concatenation;
+    while (supported_ && !at_end() && peek() != '|' && peek() != ')') {
+      result.children.push_back(parse_quantified());
+    }
+    if (result.children.empty()) {
+      return Pattern_Node();
+    }
+    if (result.children.size() == 1) {
+      return result.children.front();
+    }
+    return result;
+  }
+
+  Pattern_Node parse_quantified()
+  {
+    auto atom = parse_atom();
+
+    size_t min = 0;
+    size_t max = 0;
+    switch (peek()) {
+      case '*': next(); min = 0; max = Pattern_Node::unbounded; break;
+      case '+': next(); min = 1; max = Pattern_Node::unbounded; break;
+      case '?': next(); min = 0; max = 1; break;
+      case '{':
+        next();
+        min = max = parse_count();
+        if (peek() == ',') {
+          next();
+          max = peek() == '}' ? Pattern_Node::unbounded : parse_count();
+        }
+        if (next() != '}') {
+          return unsupported();
+        }
+        break;
+      default:
+        return atom;
+    }
+
+    // Lazy quantifiers prefer shorter matches, which a DFA cannot express.
+    if (peek() == '?' || atom.kind == Pattern_Node::Kind::word_boundary
+        || (max != Pattern_Node::unbounded && max > max_repetition_count)
+        || min > max_repetition_count)
+    {
+      return unsupported();
+    }
+
+    Pattern_Node result;
+    result.kind = Pattern_Node::Kind::repetition;
+    result.min = min;
+    result.max = max;
+    result.children.push_back(atom);
+    return result;
+  }
+
+  size_t parse_count()
+  {
+    if (peek() < '0' || peek() > '9') {
+      unsupported();
+      return 0;
+    }
+    size_t count = 0;
+    while (peek() >= '0' && peek() <= '9') {
+      count = std::min(count * 10 + (next() - '0'), max_repetition_count + 1);
+    }
+    return count;
+  }
+
+  Pattern_Node parse_atom()
+  {
+    Pattern_Node result;
+    result.kind = Pattern_Node::Kind::bytes;
+
+    auto ch = next();
+    switch (ch) {
+      case '(':
+        if (peek() == '?') {
+          next();
+          // Only non-capturing groups are supported, not lookaheads.
+          if (next() != ':') {
+            return unsupported();
+          }
+        }
+        result = parse_alternation();
+        if (next() != ')') {
+          return unsupported();
+        }
+        return result;
+
+      case '[':
+        if (!parse_class(&result.bytes)) {
+          return unsupported();
+        }
+        return result;
+
+      case '.':
+        result.bytes.set();
+        result.bytes.reset('\n');
+        result.bytes.reset('\r');
+        return result;
+
+      case '\\':
+        if (peek() == 'b') {
+          next();
+          result.kind = Pattern_Node::Kind::word_boundary;
+          return result;
+        }
+        if (!parse_escape(&result.bytes, false)) {
+          return unsupported();
+        }
+        return result;
+
+      case '^': case '$': case '{': case '*': case '+': case '?':
+        return unsupported();
+
+      default:
+        result.bytes.set(static_cast<unsigned char>(ch));
+        return result;
+    }
+  }
+
+  /**
+   * Parses the rest of a bracketed class, after the opening '['.
+   */
+  bool parse_class(Byte_Set * bytes)
+  {
+    auto const negated = peek() == '^';
+    if (negated) {
+      next();
+    }
+
+    while (supported_ && !at_end() && peek() != ']') {
+      Byte_Set item;
+      bool is_single_byte = true;
+      auto first = static_cast<unsigned char>(peek());
+
+      if (peek() == '[' && position_ + 1 < expression_.size()
+          && (expression_[position_ + 1] == ':'
+            || expression_[position_ + 1] == '.'
+            || expression_[position_ + 1] == '='))
+      {
+        // POSIX character classes and collating elements.
+        return false;
+      }
+      else if (peek() == '\\') {
+        next();
+        auto const escape = peek();
+        is_single_byte = escape != 'd' && escape != 'D' && escape != 'w'
+          && escape != 'W' && escape != 's' && escape != 'S';
+        if (!parse_escape(&item, true)) {
+          return false;
+        }
+        if (is_single_byte) {
+          first = lowest_byte(item);
+        }
+      }
+      else {
+        next();
+        item.set(first);
+      }
+
+      // A '-' at the end of the class is literal rather than a range.
+      if (peek() == '-' && position_ + 1 < expression_.size()
+          && expression_[position_ + 1] != ']')
+      {
+        next();
+        Byte_Set last_item;
+        auto last = static_cast<unsigned char>(peek());
+        if (peek() == '\\') {
+          next();
+          auto const escape = peek();
+          if (escape == 'd' || escape == 'D' || escape == 'w'
+              || escape == 'W' || escape == 's' || escape == 'S'
+              || !parse_escape(&last_item, true))
+          {
+            return false;
+          }
+          last = lowest_byte(last_item);
+        }
+        else {
+          next();
+        }
+        if (!is_single_byte || last < first) {
+          return false;
+        }
+        item = byte_range(first, last);
+      }
+      *bytes |= item;
+    }
+
+    if (next() != ']') {
+      return false;
+    }
+    if (negated) {
+      bytes->flip();
+    }
+    return true;
+  }
+
+  /**
+   * Parses an escape sequence, after the '\\'.
+   */
+  bool parse_escape(Byte_Set * bytes, bool in_class)
+  {
+    auto const ch = next();
+    switch (ch) {
+      case 'd': *bytes = byte_range('0', '9'); return true;
+      case 'D': *bytes = ~byte_range('0', '9'); return true;
+      case 'w': *bytes = word_bytes(); return true;
+      case 'W': *bytes = ~word_bytes(); return true;
+      case 's': *bytes = byte_range('\t', '\r') | byte_range(' ', ' '); return true;
+      case 'S': *bytes = ~(byte_range('\t', '\r') | byte_range(' ', ' ')); return true;
+      case 't': bytes->set('\t'); return true;
+      case 'n': bytes->set('\n'); return true;
+      case 'v': bytes->set('\v'); return true;
+      case 'f': bytes->set('\f'); return true;
+      case 'r': bytes->set('\r'); return true;
+      case 'b':
+        // Backspace within a class, otherwise a word boundary handled by the
+        // caller.
+        if (!in_class) {
+          return false;
+        }
+        bytes->set('\b');
+        return true;
+      case '0':
+        if (peek() >= '0' && peek() <= '9') {
+          return false;
+        }
+        bytes->set(0);
+        return true;
+      case 'c':
+        if (!std::isalpha(static_cast<unsigned char>(peek()))) {
+          return false;
+        }
+        bytes->set(static_cast<unsigned char>(next()) % 32);
+        return true;
+      case 'x':
+      case 'u': {
+        auto const digits = ch == 'x' ? 2 : 4;
+        size_t value = 0;
+        for (auto i = 0; i < digits; ++i) {
+          auto const digit = static_cast<unsigned char>(next());
+          if (!std::isxdigit(digit)) {
+            return false;
+          }
+          value = value * 16 + (std::isdigit(digit) ? digit - '0' : std::tolower(digit) - 'a' + 10);
+        }
+        if (value > 0xFF) {
+          return false;
+        }
+        bytes->set(value);
+        return true;
+      }
+      case '\0':
+        return false;
+      default:
+        // Back-references and other assertions.
+        if ((ch >= '1' && ch <= '9') || ch == 'B') {
+          return false;
+        }
+        bytes->set(static_cast<unsigned char>(ch));
+        return true;
+    }
+  }
+};
+
+
+bool
+contains_word_boundary(Pattern_Node const & node)
+{
+  if (node.kind == Pattern_Node::Kind::word_boundary) {
+    return true;
+  }
+  for (auto const & child : node.children) {
+    if (contains_word_boundary(child)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+bool
+is_nullable(Pattern_Node const & node)
+{
+  switch (node.kind) {
+    case Pattern_Node::Kind::bytes:
+      return false;
+    case Pattern_Node::Kind::concatenation:
+      return std::all_of(node.children.begin(), node.children.end(), is_nullable);
+    case Pattern_Node::Kind::alternation:
+      return std::any_of(node.children.begin(), node.children.end(), is_nullable);
+    case Pattern_Node::Kind::repetition:
+      return node.min == 0 || is_nullable(node.children.front());
+    case Pattern_Node::Kind::empty:
+    case Pattern_Node::Kind::word_boundary:
+    default:
+      return true;
+  }
+}
+
+
+Byte_Set
+first_bytes(Pattern_Node const & node)
+{
+  Byte_Set result;
+  switch (node.kind) {
+    case Pattern_Node::Kind::bytes:
+      return node.bytes;
+    case Pattern_Node::Kind::concatenation:
+      // Bytes of each child until one must consume something.
+      for (auto const & child : node.children) {
+        result |= first_bytes(child);
+        if (!is_nullable(child)) {
+          break;
+        }
+      }
+      return result;
+    case Pattern_Node::Kind::alternation:
+      for (auto const & child : node.children) {
+        result |= first_bytes(child);
+      }
+      return result;
+    case Pattern_Node::Kind::repetition:
+      return node.max == 0 ? result : first_bytes(node.children.front());
+    case Pattern_Node::Kind::empty:
+    case Pattern_Node::Kind::word_boundary:
+    default:
+      return result;
+  }
+}
+
+
+/**
+ * Thompson construction of a single NFA from all patterns.  Each state either
+ * consumes a byte from its set, or follows epsilon transitions, listed in the
+ * order `std::regex` would try them.
+ */
+struct Nfa_State {
+  static constexpr size_t none = static_cast<size_t>(-1);
+
+  Byte_Set bytes;
+  size_t byte_target = none;
+  vector<size_t> epsilon;
+  size_t accept = Scanner::no_match;
+};
+
+constexpr size_t Nfa_State::none;
+
+
+class Nfa_Builder {
+public:
+  using Fragment = std::pair<size_t, size_t>;
+
+  vector<Nfa_State> states;
+
+  size_t add_state()
+  {
+    states.emplace_back();
+    return states.size() - 1;
+  }
+
+  void connect(size_t from, size_t to)
+  {
+    states[from].epsilon.push_back(to);
+  }
+
+  Fragment build(Pattern_Node const & node)
+  {
+    switch (node.kind) {
+      case Pattern_Node::Kind::bytes: {
+        auto const start = add_state();
+        auto const end = add_state();
+        states[start].bytes = node.bytes;
+        states[start].byte_target = end;
+        return {start, end};
+      }
+
+      case Pattern_Node::Kind::concatenation: {
+        auto const start = add_state();
+        auto end = start;
+        for (auto const & child : node.children) {
+          auto const fragment = build(child);
+          connect(end, fragment.first);
+          end = fragment.second;
+        }
+        return {start, end};
+      }
+
+      case Pattern_Node::Kind::alternation: {
+        auto const start = add_state();
+        auto const end = add_state();
+        for (auto const & child : node.children) {
+          auto const fragment = build(child);
+          connect(start, fragment.first);
+          connect(fragment.second, end);
+        }
+        return {start, end};
+      }
+
+      case Pattern_Node::Kind::repetition: {
+        auto const start = add_state();
+        auto current = start;
+        for (size_t i = 0; i < node.min; ++i) {
+          auto const fragment = build(node.children.front());
+          connect(current, fragment.first);
+          current = fragment.second;
+        }
+
+        auto const end = add_state();
+        if (node.max == Pattern_Node::unbounded) {
+          auto const loop = add_state();
+          auto const fragment = build(node.children.front());
+          connect(current, loop);
+          connect(loop, fragment.first);
+          connect(fragment.second, loop);
+          connect(loop, end);
+        }
+        else {
+          for (size_t i = node.min; i < node.max; ++i) {
+            auto const fragment = build(node.children.front());
+            connect(current, fragment.first);
+            connect(current, end);
+            current = fragment.second;
+          }
+          connect(current, end);
+        }
+        return {start, end};
+      }
+
+      case Pattern_Node::Kind::empty:
+      case Pattern_Node::Kind::word_boundary:
+      default: {
+        auto const state = add_state();
+        return {state, state};
+      }
+    }
+  }
+
+  vector<size_t> closure(vector<size_t> const & initial) const
+  {
+    vector<bool> visited(states.size(), false);
+    vector<size_t> pending(initial);
+    vector<size_t> result;
+    while (!pending.empty()) {
+      auto const state = pending.back();
+      pending.pop_back();
+      if (visited[state]) {
+        continue;
+      }
+      visited[state] = true;
+      result.push_back(state);
+      pending.insert(pending.end(), states[state].epsilon.begin(), states[state].epsilon.end());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+};
+
+
+// Upper limit on the pairs of states explored when comparing runs through a
+// pattern, beyond which they are assumed to differ.
+constexpr size_t max_run_pairs = 1 << 16;
+
+
+/**
+ * Whether `std::regex`, which tries alternatives in order and repetitions
+ * greedily, can match a shorter string than the longest match of `root`, as
+ * with `<|<=` or `a*(ab)?`.  That needs a run through the NFA which it prefers
+ * to accept a non-empty proper prefix of the string accepted by a run it tries
+ * later, so both runs are followed side by side from every state where they
+ * could part ways, in the order the NFA lists their choices.
+ */
+bool
+prefers_shorter_match(Pattern_Node const & root)
+{
+  Nfa_Builder nfa;
+  auto const fragment = nfa.build(root);
+  auto const & states = nfa.states;
+
+  // States from which the end can still be reached.
+  vector<vector<size_t>> predecessors(states.size());
+  for (size_t state = 0; state < states.size(); ++state) {
+    if (states[state].byte_target != Nfa_State::none) {
+      predecessors[states[state].byte_target].push_back(state);
+    }
+    for (auto const target : states[state].epsilon) {
+      predecessors[target].push_back(state);
+    }
+  }
+  vector<bool> reaches_end(states.size(), false);
+  vector<size_t> pending = {fragment.second};
+  while (!pending.empty()) {
+    auto const state = pending.back();
+    pending.pop_back();
+    if (reaches_end[state]) {
+      continue;
+    }
+    reaches_end[state] = true;
+    pending.insert(pending.end(), predecessors[state].begin(), predecessors[state].end());
+  }
+
+  // States reachable from the start, indexed by state * 2 + whether a byte
+  // was consumed on the way.
+  vector<bool> reached(states.size() * 2, false);
+  pending = {fragment.first * 2};
+  while (!pending.empty()) {
+    auto const index = pending.back();
+    pending.pop_back();
+    if (reached[index]) {
+      continue;
+    }
+    reached[index] = true;
+    auto const & state = states[index / 2];
+    if (state.byte_target != Nfa_State::none) {
+      pending.push_back(state.byte_target * 2 + 1);
+    }
+    for (auto const target : state.epsilon) {
+      pending.push_back(target * 2 + index % 2);
+    }
+  }
+
+  // The states of the preferred and the later run, and whether the preferred
+  // run has consumed a byte.  Where the later run passes through a state the
+  // preferred run could also be in, the preferred run can go on alike, so any
+  // difference shows up where they part again.
+  using Runs = std::tuple<size_t, size_t, bool>;
+  std::set<Runs> visited;
+  vector<Runs> runs;
+  auto const add_runs = [&](size_t preferred_state, size_t later_state, bool consumed) {
+    auto const preferred_states = nfa.closure({preferred_state});
+    vector<bool> seen(states.size(), false);
+    for (auto const state : preferred_states) {
+      seen[state] = true;
+    }
+    vector<size_t> later_states = {later_state};
+    while (!later_states.empty()) {
+      auto const later = later_states.back();
+      later_states.pop_back();
+      if (seen[later]) {
+        continue;
+      }
+      seen[later] = true;
+      later_states.insert(later_states.end(), states[later].epsilon.begin(), states[later].epsilon.end());
+      for (auto const preferred : preferred_states) {
+        if (visited.insert(Runs(preferred, later, consumed)).second) {
+          runs.emplace_back(preferred, later, consumed);
+        }
+      }
+    }
+  };
+  for (size_t state = 0; state < states.size(); ++state) {
+    auto const & choices = states[state].epsilon;
+    if (!reached[state * 2] && !reached[state * 2 + 1]) {
+      continue;
+    }
+    for (size_t first = 0; first < choices.size(); ++first) {
+      for (size_t second = first + 1; second < choices.size(); ++second) {
+        add_runs(choices[first], choices[second], reached[state * 2 + 1]);
+      }
+    }
+  }
+
+  while (!runs.empty()) {
+    if (visited.size() > max_run_pairs) {
+      return true;
+    }
+    size_t preferred_state, later_state;
+    bool consumed;
+    std::tie(preferred_state, later_state, consumed) = runs.back();
+    runs.pop_back();
+    auto const & preferred = states[preferred_state];
+    auto const & later = states[later_state];
+    if (later.byte_target == Nfa_State::none || !reaches_end[later.byte_target]) {
+      continue;
+    }
+    if (preferred_state == fragment.second && consumed) {
+      return true;
+    }
+    if (preferred.byte_target != Nfa_State::none && (preferred.bytes & later.bytes).any()) {
+      add_runs(preferred.byte_target, later.byte_target, true);
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+
+bool
+parse_pattern(string const & expression, Pattern * pattern)
+{
+  Pattern result;
+  Pattern_Parser parser(expression);
+  if (!parser.parse(&result.root)) {
+    return false;
+  }
+
+  auto & root = result.root;
+  if (root.kind == Pattern_Node::Kind::word_boundary) {
+    return false;
+  }
+  if (root.kind == Pattern_Node::Kind::concatenation) {
+    auto & children = root.children;
+    if (children.front().kind == Pattern_Node::Kind::word_boundary) {
+      result.word_boundary_before = true;
+      children.erase(children.begin());
+    }
+    if (!children.empty() && children.back().kind == Pattern_Node::Kind::word_boundary) {
+      result.word_boundary_after = true;
+      children.pop_back();
+    }
+  }
+  if (contains_word_boundary(root) || prefers_shorter_match(root)) {
+    return false;
+  }
+
+  *pattern = result;
+  return true;
+}
+
+
+Byte_Set
+first_bytes(Pattern const & pattern)
+{
+  auto result = first_bytes(pattern.root);
+  if (pattern.word_boundary_before) {
+    result &= word_bytes();
+  }
+  return result;
+}
+
+
+Scanner::Scanner()
+  : class_count_(0)
+  , start_state_(dead_state)
+{
+  std::fill(std::begin(byte_classes_), std::end(byte_classes_), 0);
+}
+
+
+/**
+ * Adds a pattern with a lower priority than all previously added ones.
+ * Returns false, leaving the scanner unchanged, if the expression cannot be
+ * compiled (see `parse_pattern`).
+ *
+ * Patterns take effect at the next `compile`.
+ */
+bool
+Scanner::add_pattern(string const & expression)
+{
+  Pattern pattern;
+  if (!parse_pattern(expression, &pattern)) {
+    return false;
+  }
+  add_pattern(pattern);
+  return true;
+}
+
+
+void
+Scanner::add_pattern(Pattern const & pattern)
+{
+  patterns_.push_back(pattern);
+}
+
+
+/**
+ * Builds the DFA for all patterns added so far.  Returns false if the
+ * automaton would be unreasonably large, in which case the scanner matches
+ * nothing.
+ */
+bool
+Scanner::compile()
+{
+  transitions_.clear();
+  accept_offsets_.clear();
+  accepts_.clear();
+  runs_.clear();
+
+  // Combined NFA, with a start state leading to each pattern.
+  Nfa_Builder nfa;
+  auto const nfa_start = nfa.add_state();
+  for (size_t i = 0; i < patterns_.size(); ++i) {
+    auto const fragment = nfa.build(patterns_[i].root);
+    nfa.connect(nfa_start, fragment.first);
+    nfa.states[fragment.second].accept = i;
+  }
+
+  // Split bytes into classes which every byte set either wholly contains or
+  // wholly excludes.
+  std::fill(std::begin(byte_classes_), std::end(byte_classes_), 0);
+  class_count_ = 1;
+  for (auto const & state : nfa.states) {
+    if (state.byte_target == Nfa_State::none) {
+      continue;
+    }
+    vector<int> split(class_count_ * 2, -1);
+    size_t next_class_count = 0;
+    for (size_t byte = 0; byte < 256; ++byte) {
+      auto & new_class = split[byte_classes_[byte] * 2 + state.bytes.test(byte)];
+      if (new_class < 0) {
+        new_class = static_cast<int>(next_class_count++);
+      }
+      byte_classes_[byte] = static_cast<std::uint16_t>(new_class);
+    }
+    class_count_ = next_class_count;
+  }
+
+  vector<unsigned char> class_representative(class_count_);
+  for (size_t byte = 256; byte-- > 0;) {
+    class_representative[byte_classes_[byte]] = static_cast<unsigned char>(byte);
+  }
+
+  // Subset construction, with the empty set as the dead state.
+  std::map<vector<size_t>, State> dfa_state_ids;
+  vector<vector<size_t>> dfa_states;
+  vector<State> transitions;
+
+  auto const find_or_add = [&](vector<size_t> const & nfa_states) {
+    auto const it = dfa_state_ids.find(nfa_states);
+    if (it != dfa_state_ids.end()) {
+      return it->second;
+    }
+    auto const id = static_cast<State>(dfa_states.size());
+    dfa_state_ids.emplace(nfa_states, id);
+    dfa_states.push_back(nfa_states);
+    return id;
+  };
+
+  find_or_add({});
+  auto const start = find_or_add(nfa.closure({nfa_start}));
+
+  for (size_t current = 0; current < dfa_states.size(); ++current) {
+    if (dfa_states.size() > max_dfa_states) {
+      return false;
+    }
+    for (size_t byte_class = 0; byte_class < class_count_; ++byte_class) {
+      auto const byte = class_representative[byte_class];
+      vector<size_t> targets;
+      for (auto const nfa_state : dfa_states[current]) {
+        auto const & state = nfa.states[nfa_state];
+        if (state.byte_target != Nfa_State::none && state.bytes.test(byte)) {
+          targets.push_back(state.byte_target);
+        }
+      }
+      auto const target = find_or_add(nfa.closure(targets));
+      transitions.push_back(target);
+    }
+  }
+
+  // Patterns accepted by each DFA state, ordered by priority.
+  vector<vector<std::uint32_t>> accepted(dfa_states.size());
+  for (size_t state = 0; state < dfa_states.size(); ++state) {
+    for (auto const nfa_state : dfa_states[state]) {
+      if (nfa.states[nfa_state].accept != no_match) {
+        accepted[state].push_back(static_cast<std::uint32_t>(nfa.states[nfa_state].accept));
+      }
+    }
+    std::sort(accepted[state].begin(), accepted[state].end());
+  }
+
+  // Minimize by refining the partition of states by accepted patterns until
+  // states in the same block also transition into the same blocks.
+  vector<State> block(dfa_states.size());
+  size_t block_count = 0;
+  {
+    std::map<vector<std::uint32_t>, State> initial_blocks;
+    for (size_t state = 0; state < dfa_states.size(); ++state) {
+      auto const inserted = initial_blocks.emplace(accepted[state], static_cast<State>(initial_blocks.size()));
+      block[state] = inserted.first->second;
+    }
+    block_count = initial_blocks.size();
+  }
+
+  while (true) {
+    std::map<vector<State>, State> refined_blocks;
+    vector<State> refined(dfa_states.size());
+    for (size_t state = 0; state < dfa_states.size(); ++state) {
+      vector<State> signature;
+      signature.reserve(class_count_ + 1);
+      signature.push_back(block[state]);
+      for (size_t byte_class = 0; byte_class < class_count_; ++byte_class) {
+        signature.push_back(block[transitions[state * class_count_ + byte_class]]);
+      }
+      auto const inserted = refined_blocks.emplace(signature, static_cast<State>(refined_blocks.size()));
+      refined[state] = inserted.first->second;
+    }
+    std::swap(block, refined);
+    if (refined_blocks.size() == block_count) {
+      break;
+    }
+    block_count = refined_blocks.size();
+  }
+
+  // Renumber blocks so the dead state keeps its id.
+  vector<State> renumbered(block_count, static_cast<State>(block_count));
+  State next_id = 0;
+  renumbered[block[dead_state]] = next_id++;
+  for (size_t state = 0; state < dfa_states.size(); ++state) {
+    if (renumbered[block[state]] == block_count) {
+      renumbered[block[state]] = next_id++;
+    }
+  }
+
+  transitions_.assign(block_count * class_count_, dead_state);
+  vector<vector<std::uint32_t> const *> block_accepts(block_count, nullptr);
+  for (size_t state = 0; state < dfa_states.size(); ++state) {
+    auto const id = renumbered[block[state]];
+    block_accepts[id] = &accepted[state];
+    for (size_t byte_class = 0; byte_class < class_count_; ++byte_class) {
+      transitions_[id * class_count_ + byte_class] =
+        renumbered[block[transitions[state * class_count_ + byte_class]]];
+    }
+  }
+  start_state_ = renumbered[block[start]];
+
+  accept_offsets_.push_back(0);
+  for (auto const accepts : block_accepts) {
+    accepts_.insert(accepts_.end(), accepts->begin(), accepts->end());
+    accept_offsets_.push_back(static_cast<std::uint32_t>(accepts_.size()));
+  }
+
+  // Within a run, whether a word boundary follows can change at every byte,
+  // so only states without such patterns skip runs.
+  runs_.assign(block_count, Byte_Ranges());
+  for (State state = 0; state < block_count; ++state) {
+    if (state == dead_state) {
+      continue;
+    }
+    auto const accepts = block_accepts[state];
+    auto const boundary_after = std::any_of(accepts->begin(), accepts->end(), [&](std::uint32_t pattern) {
+      return patterns_[pattern].word_boundary_after;
+    });
+    if (boundary_after) {
+      continue;
+    }
+    Byte_Set loop;
+    for (size_t byte = 0; byte < 256; ++byte) {
+      loop[byte] = transitions_[state * class_count_ + byte_classes_[byte]] == state;
+    }
+    if (loop.any()) {
+      Byte_Ranges::from_set(loop, &runs_[state]);
+    }
+  }
+  return true;
+}
+
+
+/**
+ * Finds the highest priority pattern matching a prefix of [begin, end), and
+ * the length of its longest match.  Anything before `begin` is treated as a
+ * non-word character for word boundaries, as is `end`.
+ */
+Scanner::Match
+Scanner::match(char_type const * begin, char_type const * end) const
+{
+  Match best {no_match, 0, 0};
+  if (transitions_.empty()) {
+    return best;
+  }
+
+  auto state = start_state_;
+  auto current = begin;
+
+  auto const accept = [&]() {
+    for (auto i = accept_offsets_[state]; i != accept_offsets_[state + 1]; ++i) {
+      auto const pattern = accepts_[i];
+      if (pattern > best.pattern) {
+        break;
+      }
+      auto const length = static_cast<size_t>(current - begin);
+      if (accepts_at(pattern, begin, end, length)) {
+        best.pattern = pattern;
+        best.length = length;
+        break;
+      }
+    }
+  };
+
+  while (true) {
+    if (current == end) {
+      best.examined = static_cast<size_t>(end - begin) + 1;
+      break;
+    }
+    state = transitions_[state * class_count_ + byte_classes_[static_cast<unsigned char>(*current)]];
+    if (state == dead_state) {
+      best.examined = static_cast<size_t>(current - begin) + 1;
+      break;
+    }
+    ++current;
+    accept();
+
+    // The state and so its accepted patterns stay the same until the run
+    // ends, leaving only the match length to update.
+    auto const & run = runs_[state];
+    if (run.count != 0) {
+      auto const run_end = find_run_end(current, end, run);
+      if (run_end != current) {
+        current = run_end;
+        accept();
+      }
+    }
+  }
+  return best;
+}
+
+
+bool
+Scanner::accepts_at(
+  size_t pattern,
+  char_type const * begin,
+  char_type const * end,
+  size_t length) const
+{
+  auto const & flags = patterns_[pattern];
+  if (flags.word_boundary_before && !is_word_byte(*begin)) {
+    return false;
+  }
+  if (flags.word_boundary_after) {
+    auto const next_is_word = begin + length != end && is_word_byte(begin[length]);
+    return is_word_byte(begin[length - 1]) != next_is_word;
+  }
+  return true;
+}
+
+} // namespace parka
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "byte_runs.hpp"
+#include "string.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace parka {
+
+using std::vector;
+
+/**
+ * Syntax tree of a regular expression in the subset of ECMAScript supported by
+ * the scanner.
+ */
+struct Pattern_Node {
+  enum class Kind {
+    empty,          ///< Matches the empty string.
+    bytes,          ///< Matches any single byte in `bytes`.
+    concatenation,  ///< Matches each child in turn.
+    alternation,    ///< Matches any one of the children.
+    repetition,     ///< Matches the only child between `min` and `max` times.
+    word_boundary   ///< `\b`, only permitted at either end of a pattern.
+  };
+
+  static constexpr size_t unbounded = static_cast<size_t>(-1);
+
+  Kind kind = Kind::empty;
+  Byte_Set bytes;
+  vector<Pattern_Node> children;
+  size_t min = 0;
+  size_t max = 0;
+};
+
+
+/**
+ * A parsed pattern.  Word boundaries are only allowed at the very beginning or
+ * end of a pattern (as created by `Lexer::register_keyword`), so are kept as
+ * flags rather than as part of the tree.
+ */
+struct Pattern {
+  Pattern_Node root;
+  bool word_boundary_before = false;
+  bool word_boundary_after = false;
+};
+
+
+/**
+ * Parses an ECMAScript regular expression into a `Pattern`.  Returns false if
+ * the expression uses features which cannot be expressed by a finite
+ * automaton (back-references, lookaheads, lazy quantifiers, anchors or word
+ * boundaries within the pattern), or where `std::regex`, trying alternatives
+ * in order and repetitions greedily, can match less than the longest match
+ * (e.g. `<|<=` or `a*(ab)?`).
+ *
+ * The expression is expected to have already been accepted by `std::regex`,
+ * so this is not a validating parser.
+ */
+bool parse_pattern(string const & expression, Pattern * pattern);
+
+
+/**
+ * The bytes which can begin a non-empty match of the pattern.
+ */
+Byte_Set first_bytes(Pattern const & pattern);
+
+
+/**
+ * Combines any number of patterns into a single minimized DFA which finds the
+ * matching pattern for an input position in one pass over the input.
+ *
+ * When multiple patterns match, the one added first wins, and its longest
+ * match is the result.  This gives the same results as trying each pattern in
+ * turn with `std::regex`, as `parse_pattern` rejects patterns for which its
+ * match could be shorter than the longest.
+ *
+ * Empty matches are never reported, since they would not advance the input.
+ *
+ * States which loop back to themselves on a few ranges of bytes, like those
+ * inside an identifier, a number or a string, skip over such runs with
+ * `find_run_end` rather than a byte at a time.
+ */
+class Scanner {
+public:
+  static constexpr size_t no_match = static_cast<size_t>(-1);
+
+  struct Match {
+    /// Index of the matched pattern in the order added, or `no_match`.
+    size_t pattern;
+    size_t length;
+
+    /// Number of bytes the result depends on.  This is one more than the
+    /// size of the input if what follows the input could change the result.
+    size_t examined;
+  };
+
+  Scanner();
+
+  bool add_pattern(string const & expression);
+  void add_pattern(Pattern const & pattern);
+  bool compile();
+
+  Match match(char_type const * begin, char_type const * end) const;
+
+  size_t pattern_count() const { return patterns_.size(); }
+  size_t state_count() const { return accept_offsets_.empty() ? 0 : accept_offsets_.size() - 1; }
+
+private:
+  using State = std::uint32_t;
+
+  static constexpr State dead_state = 0;
+
+  vector<Pattern> patterns_;
+
+  // Bytes which no pattern distinguishes between share a column of the
+  // transition table.
+  std::uint16_t byte_classes_[256];
+  size_t class_count_;
+
+  State start_state_;
+  vector<State> transitions_;
+
+  // Patterns accepted by state `s` are accepts_[accept_offsets_[s]] until
+  // accepts_[accept_offsets_[s + 1]], in ascending order.
+  vector<std::uint32_t> accept_offsets_;
+  vector<std::uint32_t> accepts_;
+
+  // Bytes on which each state transitions to itself, if it is worth skipping
+  // over them together; otherwise empty.
+  vector<Byte_Ranges> runs_;
+
+  bool accepts_at(
+      size_t pattern,
+      char_type const * begin,
+      char_type const * end,
+      size_t length) const;
+};
+
+} // namespace parka
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include "scanner.hpp"
+#include "string.hpp"
+using namespace parka;
+
+
+class Scanner_Test : public ::testing::Test {
+protected:
+  Scanner scanner;
+
+  void add_patterns(std::vector<string> const & patterns)
+  {
+    for (auto const & pattern : patterns) {
+      ASSERT_TRUE(scanner.add_pattern(pattern)) << pattern;
+    }
+    ASSERT_TRUE(scanner.compile());
+  }
+
+  Scanner::Match match(string const & input)
+  {
+    return scanner.match(input.data(), input.data() + input.size());
+  }
+
+  void EXPECT_MATCH(string const & input, size_t pattern, size_t length)
+  {
+    auto const result = match(input);
+    EXPECT_EQ(pattern, result.pattern) << input;
+    EXPECT_EQ(length, result.length) << input;
+  }
+
+  void EXPECT_NO_MATCH(string const & input)
+  {
+    EXPECT_EQ(Scanner::no_match, match(input).pattern) << input;
+  }
+};
+
+
+TEST(Pattern_Test, Unsupported_Features) {
+  Pattern pattern;
+  EXPECT_FALSE(parse_pattern("(a)\\1", &pattern));
+  EXPECT_FALSE(parse_pattern("a(?=b)", &pattern));
+  EXPECT_FALSE(parse_pattern("a*?", &pattern));
+  EXPECT_FALSE(parse_pattern("^a", &pattern));
+  EXPECT_FALSE(parse_pattern("a$", &pattern));
+  EXPECT_FALSE(parse_pattern("a\\bb", &pattern));
+  EXPECT_FALSE(parse_pattern("[[:alpha:]]", &pattern));
+}
+
+
+TEST(Pattern_Test, Shorter_Than_Longest_Match) {
+  Pattern pattern;
+  EXPECT_FALSE(parse_pattern("<|<=", &pattern));
+  EXPECT_FALSE(parse_pattern("[a-z]+|[a-z]+[0-9]+", &pattern));
+  EXPECT_FALSE(parse_pattern("x(a|ab)*", &pattern));
+  EXPECT_FALSE(parse_pattern("(ab|a)(bcd)?", &pattern));
+  EXPECT_FALSE(parse_pattern("a*(ab)?", &pattern));
+  EXPECT_FALSE(parse_pattern("a{0,2}(ab)?", &pattern));
+  EXPECT_FALSE(parse_pattern("a*(ab)*b", &pattern));
+
+  // Whichever runs std::regex prefers, it still finds the longest match.
+  EXPECT_TRUE(parse_pattern("<=|<", &pattern));
+  EXPECT_TRUE(parse_pattern("<=|<>|=", &pattern));
+  EXPECT_TRUE(parse_pattern("[1-9][0-9]*|0", &pattern));
+  EXPECT_TRUE(parse_pattern("a|a", &pattern));
+  EXPECT_TRUE(parse_pattern("(a|a)b*", &pattern));
+  EXPECT_TRUE(parse_pattern("[0-9]+(\\.[0-9]+)?\\.?", &pattern));
+  EXPECT_TRUE(parse_pattern("(-)?[0-9]+(\\.[0-9]+)?", &pattern));
+  EXPECT_TRUE(parse_pattern("\"([^\"\\\\]|(\\\\.))*\"", &pattern));
+}
+
+
+TEST(Pattern_Test, Word_Boundaries) {
+  Pattern pattern;
+  ASSERT_TRUE(parse_pattern("\\bfor\\b", &pattern));
+  EXPECT_TRUE(pattern.word_boundary_before);
+  EXPECT_TRUE(pattern.word_boundary_after);
+
+  ASSERT_TRUE(parse_pattern("for\\b", &pattern));
+  EXPECT_FALSE(pattern.word_boundary_before);
+  EXPECT_TRUE(pattern.word_boundary_after);
+}
+
+
+TEST(Pattern_Test, First_Bytes) {
+  Pattern pattern;
+  ASSERT_TRUE(parse_pattern("(-)?[0-9]+", &pattern));
+  auto bytes = first_bytes(pattern);
+  EXPECT_EQ(11u, bytes.count());
+  EXPECT_TRUE(bytes.test('-'));
+  EXPECT_TRUE(bytes.test('7'));
+
+  ASSERT_TRUE(parse_pattern("\\b[a-z-]+", &pattern));
+  bytes = first_bytes(pattern);
+  EXPECT_EQ(26u, bytes.count());
+  EXPECT_FALSE(bytes.test('-'));
+}
+
+
+TEST_F(Scanner_Test, Longest_Match) {
+  add_patterns({"[a-z]+"});
+  EXPECT_MATCH("abc def", 0, 3);
+  EXPECT_MATCH("x", 0, 1);
+  EXPECT_NO_MATCH("123");
+  EXPECT_NO_MATCH("");
+}
+
+
+TEST_F(Scanner_Test, First_Registered_Pattern_Wins) {
+  add_patterns({"[0-9]+", "[a-z0-9]+", "[a-z]+"});
+  EXPECT_MATCH("123", 0, 3);
+  EXPECT_MATCH("123abc", 0, 3);
+  EXPECT_MATCH("abc123", 1, 6);
+  EXPECT_MATCH("abc", 1, 3);
+}
+
+
+TEST_F(Scanner_Test, Keywords) {
+  add_patterns({"\\bfor\\b", "\\bin\\b", "[a-zA-Z_][a-zA-Z_0-9]*"});
+  EXPECT_MATCH("for x", 0, 3);
+  EXPECT_MATCH("for", 0, 3);
+  EXPECT_MATCH("for(", 0, 3);
+  EXPECT_MATCH("foreach", 2, 7);
+  EXPECT_MATCH("in", 1, 2);
+  EXPECT_MATCH("inner", 2, 5);
+}
+
+
+TEST_F(Scanner_Test, Character_Classes) {
+  add_patterns({"\"[^\"\\\\]*\"", "\\d{2,3}", "[\\w-]+"});
+  EXPECT_MATCH("\"ab cd\" x", 0, 7);
+  EXPECT_MATCH("12345", 1, 3);
+  EXPECT_MATCH("a-b_c d", 2, 5);
+}
+
+
+TEST_F(Scanner_Test, Any_Excludes_Line_Terminators) {
+  add_patterns({"#.*"});
+  EXPECT_MATCH("# comment\nnext", 0, 9);
+  EXPECT_MATCH("# comment\r\n", 0, 9);
+}
+
+
+TEST_F(Scanner_Test, Empty_Matches_Ignored) {
+  add_patterns({"a*", "b"});
+  EXPECT_MATCH("aab", 0, 2);
+  EXPECT_MATCH("b", 1, 1);
+}
+
+
+TEST_F(Scanner_Test, Minimized_State_Count) {
+  // Both alternatives lead to equivalent states.
+  add_patterns({"(ab|cb)c*"});
+  EXPECT_EQ(4u, scanner.state_count());
+  EXPECT_MATCH("abccc", 0, 5);
+  EXPECT_MATCH("cb", 0, 2);
+}
+
+
+int main(int argc, char ** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+
+TEST_F(Scanner_Test, Long_Runs) {
+  add_patterns({"\\bfor\\b", "[a-z_][a-z0-9_]*", "[0-9]+", "\"[^\"]*\""});
+  string const identifier(100, 'a');
+  EXPECT_MATCH(identifier + " x", 1, 100);
+  EXPECT_MATCH("for" + identifier, 1, 103);
+  EXPECT_MATCH("for " + identifier, 0, 3);
+  EXPECT_MATCH(string(70, '9') + "a", 2, 70);
+  EXPECT_MATCH("\"" + identifier + " " + identifier + "\"", 3, 203);
+  EXPECT_NO_MATCH("\"" + identifier);
+
+  auto const unterminated = "\"" + identifier;
+  auto const result = match(unterminated);
+  EXPECT_EQ(unterminated.size() + 1, result.examined);
+}
@@ -0,0 +1,772 @@
+#pragma once
+
+#include "grammar.hpp"
+#include "ll.hpp"
+#include "string.hpp"
+#include "symbol.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace parka {
+
+/**
+ * A symbol named by a string literal, for grammars written as constants.
+ * Unlike `Symbol`, it is not interned, so can be used in constant expressions;
+ * `symbol()` interns it when the program runs.
+ */
+class Static_Symbol {
+  char const * name_;
+  size_t size_;
+
+public:
+  constexpr Static_Symbol() : name_(""), size_(0) {}
+  constexpr Static_Symbol(char const * name, size_t size) : name_(name), size_(size) {}
+
+  /**
+   * Names the same symbol as `Symbol::empty()`.
+   */
+  static constexpr Static_Symbol empty() { return Static_Symbol("empty", 5); }
+
+  /**
+   * Names the same symbol as `Symbol::right_end_marker()`.
+   */
+  static constexpr Static_Symbol right_end_marker() { return Static_Symbol("$", 1); }
+
+  constexpr char const * name() const { return name_; }
+  constexpr size_t size() const { return size_; }
+
+  constexpr bool operator==(Static_Symbol const & other) const
+  {
+    if (size_ != other.size_) {
+      return false;
+    }
+    for (size_t i = 0; i < size_; ++i) {
+      if (name_[i] != other.name_[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  constexpr bool operator!=(Static_Symbol const & other) const
+  {
+    return !((*this) == other);
+  }
+
+  Symbol symbol() const { return Symbol(string(name_, size_)); }
+};
+
+
+constexpr Static_Symbol
+operator"" _ssym(char const * name, size_t size)
+{
+  return Static_Symbol(name, size);
+}
+
+
+/**
+ * Building blocks of `Static_Parsing_Table`, which analyzes a grammar written
+ * with `Static_Symbol`s while the program is compiled.
+ *
+ * Bodies and lists of alternatives are built with `+` and `|` as for the
+ * `_sym` helpers, but have fixed capacities, since they are constants:
+ *
+ *     rule("E'"_ssym, "+"_ssym + "T"_ssym + "E'"_ssym | Static_Symbol::empty())
+ *
+ * Going over a capacity fails to compile.
+ */
+namespace static_grammar {
+
+constexpr size_t max_body_length = 16;
+constexpr size_t max_alternatives = 16;
+constexpr size_t no_index = static_cast<size_t>(-1);
+
+
+class Body {
+  Static_Symbol symbols_[max_body_length];
+  size_t size_;
+
+public:
+  constexpr Body() : symbols_ {}, size_(0) {}
+  constexpr Body(Static_Symbol const & symbol) : symbols_ {symbol}, size_(1) {}
+
+  constexpr size_t size() const { return size_; }
+  constexpr Static_Symbol const & operator[](size_t i) const { return symbols_[i]; }
+
+  constexpr void push_back(Static_Symbol const & symbol)
+  {
+    symbols_[size_] = symbol;
+    ++size_;
+  }
+};
+
+
+class Alternatives {
+  Body bodies_[max_alternatives];
+  size_t size_;
+
+public:
+  constexpr Alternatives() : bodies_ {}, size_(0) {}
+  constexpr Alternatives(Body const & body) : bodies_ {body}, size_(1) {}
+
+  constexpr size_t size() const { return size_; }
+  constexpr Body const & operator[](size_t i) const { return bodies_[i]; }
+
+  constexpr void push_back(Body const & body)
+  {
+    bodies_[size_] = body;
+    ++size_;
+  }
+};
+
+
+constexpr Body
+operator+(Body lhs, Static_Symbol const & rhs)
+{
+  lhs.push_back(rhs);
+  return lhs;
+}
+
+
+constexpr Alternatives
+operator|(Alternatives lhs, Body const & rhs)
+{
+  lhs.push_back(rhs);
+  return lhs;
+}
+
+
+constexpr Alternatives
+operator|(Body const & lhs, Body const & rhs)
+{
+  return Alternatives(lhs) | rhs;
+}
+
+} // namespace static_grammar
+
+
+// Symbols are not in `static_grammar`, so operators on two of them need to be
+// here to be found.
+constexpr static_grammar::Body
+operator+(Static_Symbol const & lhs, Static_Symbol const & rhs)
+{
+  return static_grammar::Body(lhs) + rhs;
+}
+
+
+constexpr static_grammar::Alternatives
+operator|(Static_Symbol const & lhs, Static_Symbol const & rhs)
+{
+  return static_grammar::Body(lhs) | rhs;
+}
+
+
+namespace static_grammar {
+
+/**
+ * The alternatives of one nonterminal.  The head of the first rule is the
+ * start symbol.
+ */
+struct Rule {
+  Static_Symbol head;
+  Alternatives alternatives;
+};
+
+
+constexpr Rule
+rule(Static_Symbol const & head, Alternatives const & alternatives)
+{
+  return Rule {head, alternatives};
+}
+
+
+constexpr Rule
+rule(Static_Symbol const & head, Body const & body)
+{
+  return Rule {head, Alternatives(body)};
+}
+
+
+template <size_t Count>
+struct Rule_List {
+  Rule rules[Count];
+};
+
+
+/**
+ * The rules of a grammar, for the static `rules()` function of a grammar type
+ * given to `Static_Parsing_Table`.
+ */
+template <typename... Rules>
+constexpr Rule_List<sizeof...(Rules)>
+rules(Rules const & ... rules)
+{
+  return Rule_List<sizeof...(Rules)> {{rules...}};
+}
+
+
+/**
+ * The index of `symbol` among the first `count` of `symbols`, or `no_index`.
+ */
+template <size_t Size>
+constexpr size_t
+index_of(Static_Symbol const (&symbols)[Size], size_t count, Static_Symbol const & symbol)
+{
+  for (size_t i = 0; i < count; ++i) {
+    if (symbols[i] == symbol) {
+      return i;
+    }
+  }
+  return no_index;
+}
+
+
+template <size_t Count>
+constexpr bool
+is_head(Rule_List<Count> const & list, Static_Symbol const & symbol)
+{
+  for (size_t r = 0; r < Count; ++r) {
+    if (list.rules[r].head == symbol) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/**
+ * Numbers of each kind of symbol and of productions in a grammar, which size
+ * the arrays of its `Analysis`.  The right end marker is always a terminal.
+ */
+struct Sizes {
+  size_t nonterminals;
+  size_t terminals;
+  size_t productions;
+};
+
+
+template <size_t Count>
+constexpr Sizes
+measure(Rule_List<Count> const & list)
+{
+  Sizes sizes {0, 1, 0};
+  for (size_t r = 0; r < Count; ++r) {
+    auto const & current = list.rules[r];
+    auto first_rule_of_head = true;
+    for (size_t earlier = 0; earlier < r; ++earlier) {
+      first_rule_of_head = first_rule_of_head && list.rules[earlier].head != current.head;
+    }
+    sizes.nonterminals += first_rule_of_head ? 1 : 0;
+    sizes.productions += current.alternatives.size();
+
+    for (size_t a = 0; a < current.alternatives.size(); ++a) {
+      auto const & body = current.alternatives[a];
+      for (size_t i = 0; i < body.size(); ++i) {
+        auto const symbol = body[i];
+        if (symbol == Static_Symbol::empty() || symbol == Static_Symbol::right_end_marker() || is_head(list, symbol)) {
+          continue;
+        }
+
+        // Only counted where it first occurs.
+        auto seen = false;
+        for (size_t r2 = 0; r2 <= r && !seen; ++r2) {
+          auto const & alternatives = list.rules[r2].alternatives;
+          for (size_t a2 = 0; a2 < (r2 == r ? a + 1 : alternatives.size()) && !seen; ++a2) {
+            auto const & other = alternatives[a2];
+            for (size_t i2 = 0; i2 < (r2 == r && a2 == a ? i : other.size()) && !seen; ++i2) {
+              seen = other[i2] == symbol;
+            }
+          }
+        }
+        sizes.terminals += seen ? 0 : 1;
+      }
+    }
+  }
+  return sizes;
+}
+
+
+constexpr size_t
+slots(size_t count)
+{
+  return count == 0 ? 1 : count;
+}
+
+
+/**
+ * A grammar with its FIRST and FOLLOW sets and predictive parsing table, all
+ * indexed by number rather than by symbol.
+ *
+ * Nonterminals are numbered in order of their first rule, and terminals in
+ * order of first use, after the right end marker.  In bodies, terminal t is
+ * numbered `Nonterminals + t`, and empty symbols are left out.  Productions of
+ * the same nonterminal are numbered together, in order of their rules.
+ */
+template <size_t Nonterminals, size_t Terminals, size_t Productions>
+struct Analysis {
+  static constexpr size_t nonterminal_count = Nonterminals;
+  static constexpr size_t terminal_count = Terminals;
+  static constexpr size_t production_count = Productions;
+  static constexpr std::uint32_t no_production = std::numeric_limits<std::uint32_t>::max();
+
+  Static_Symbol nonterminals[slots(Nonterminals)] {};
+  Static_Symbol terminals[Terminals] {};
+
+  size_t heads[slots(Productions)] {};
+  Body bodies[slots(Productions)] {};
+  size_t body_symbols[slots(Productions)][max_body_length] {};
+  size_t body_sizes[slots(Productions)] {};
+
+  bool nullable[slots(Nonterminals)] {};
+  bool first[slots(Nonterminals)][Terminals] {};
+  bool follow[slots(Nonterminals)][Terminals] {};
+
+  std::uint32_t cells[slots(Nonterminals)][Terminals] {};
+
+  /// Cells where more than one production applies, which keep the first.
+  size_t conflicts = 0;
+
+  constexpr size_t nonterminal_index(Static_Symbol const & symbol) const
+  {
+    return index_of(nonterminals, Nonterminals, symbol);
+  }
+
+  constexpr size_t terminal_index(Static_Symbol const & symbol) const
+  {
+    return index_of(terminals, Terminals, symbol);
+  }
+};
+
+template <size_t Nonterminals, size_t Terminals, size_t Productions>
+constexpr size_t Analysis<Nonterminals, Terminals, Productions>::nonterminal_count;
+
+template <size_t Nonterminals, size_t Terminals, size_t Productions>
+constexpr size_t Analysis<Nonterminals, Terminals, Productions>::terminal_count;
+
+template <size_t Nonterminals, size_t Terminals, size_t Productions>
+constexpr size_t Analysis<Nonterminals, Terminals, Productions>::production_count;
+
+template <size_t Nonterminals, size_t Terminals, size_t Productions>
+constexpr std::uint32_t Analysis<Nonterminals, Terminals, Productions>::no_production;
+
+
+/**
+ * Adds the set `from` to `to`, noting in `changed` if that adds anything.
+ */
+template <size_t Terminals>
+constexpr void
+add_set(bool (&to)[Terminals], bool const (&from)[Terminals], bool & changed)
+{
+  for (size_t t = 0; t < Terminals; ++t) {
+    if (from[t] && !to[t]) {
+      to[t] = true;
+      changed = true;
+    }
+  }
+}
+
+
+template <size_t Terminals>
+constexpr void
+add_terminal(bool (&to)[Terminals], size_t terminal, bool & changed)
+{
+  if (!to[terminal]) {
+    to[terminal] = true;
+    changed = true;
+  }
+}
+
+
+/**
+ * Numbers the symbols and productions of `list` into a new `Result`.
+ */
+template <typename Result, size_t Count>
+constexpr Result
+number_symbols(Rule_List<Count> const & list)
+{
+  Result result {};
+  size_t nonterminal_count = 0;
+  for (size_t r = 0; r < Count; ++r) {
+    if (index_of(result.nonterminals, nonterminal_count, list.rules[r].head) == no_index) {
+      result.nonterminals[nonterminal_count] = list.rules[r].head;
+      ++nonterminal_count;
+    }
+  }
+
+  size_t terminal_count = 1;
+  result.terminals[0] = Static_Symbol::right_end_marker();
+  for (size_t r = 0; r < Count; ++r) {
+    auto const & alternatives = list.rules[r].alternatives;
+    for (size_t a = 0; a < alternatives.size(); ++a) {
+      for (size_t i = 0; i < alternatives[a].size(); ++i) {
+        auto const symbol = alternatives[a][i];
+        if (symbol != Static_Symbol::empty()
+            && index_of(result.nonterminals, nonterminal_count, symbol) == no_index
+            && index_of(result.terminals, terminal_count, symbol) == no_index) {
+          result.terminals[terminal_count] = symbol;
+          ++terminal_count;
+        }
+      }
+    }
+  }
+
+  size_t production = 0;
+  for (size_t n = 0; n < nonterminal_count; ++n) {
+    for (size_t r = 0; r < Count; ++r) {
+      if (list.rules[r].head != result.nonterminals[n]) {
+        continue;
+      }
+      auto const & alternatives = list.rules[r].alternatives;
+      for (size_t a = 0; a < alternatives.size(); ++a) {
+        auto const & body = alternatives[a];
+        result.heads[production] = n;
+        result.bodies[production] = body;
+        for (size_t i = 0; i < body.size(); ++i) {
+          if (body[i] == Static_Symbol::empty()) {
+            continue;
+          }
+          auto const nonterminal = result.nonterminal_index(body[i]);
+          result.body_symbols[production][result.body_sizes[production]] =
+            nonterminal != no_index ? nonterminal : nonterminal_count + result.terminal_index(body[i]);
+          ++result.body_sizes[production];
+        }
+        ++production;
+      }
+    }
+  }
+  return result;
+}
+
+
+/**
+ * Analyzes the grammar of `list` as `Grammar` does, and builds its predictive
+ * parsing table as `create_dense_parsing_table` does.  Each set is solved by
+ * iterating over the productions until nothing changes.
+ */
+template <typename Result, size_t Count>
+constexpr Result
+analyze(Rule_List<Count> const & list)
+{
+  constexpr auto nonterminals = Result::nonterminal_count;
+  constexpr auto terminals = Result::terminal_count;
+  constexpr auto production_count = Result::production_count;
+  auto result = number_symbols<Result>(list);
+
+  for (auto changed = true; changed;) {
+    changed = false;
+    for (size_t p = 0; p < production_count; ++p) {
+      auto all_nullable = true;
+      for (size_t i = 0; i < result.body_sizes[p] && all_nullable; ++i) {
+        auto const symbol = result.body_symbols[p][i];
+        all_nullable = symbol < nonterminals && result.nullable[symbol];
+      }
+      if (all_nullable && !result.nullable[result.heads[p]]) {
+        result.nullable[result.heads[p]] = true;
+        changed = true;
+      }
+    }
+  }
+
+  for (auto changed = true; changed;) {
+    changed = false;
+    for (size_t p = 0; p < production_count; ++p) {
+      auto & first = result.first[result.heads[p]];
+      for (size_t i = 0; i < result.body_sizes[p]; ++i) {
+        auto const symbol = result.body_symbols[p][i];
+        if (symbol >= nonterminals) {
+          add_terminal(first, symbol - nonterminals, changed);
+          break;
+        }
+        add_set(first, result.first[symbol], changed);
+        if (!result.nullable[symbol]) {
+          break;
+        }
+      }
+    }
+  }
+
+  result.follow[0][0] = true;
+  for (auto changed = true; changed;) {
+    changed = false;
+    for (size_t p = 0; p < production_count; ++p) {
+      for (size_t i = 0; i < result.body_sizes[p]; ++i) {
+        auto const target = result.body_symbols[p][i];
+        if (target >= nonterminals) {
+          continue;
+        }
+        auto & follow = result.follow[target];
+        auto rest_nullable = true;
+        for (size_t j = i + 1; j < result.body_sizes[p] && rest_nullable; ++j) {
+          auto const symbol = result.body_symbols[p][j];
+          if (symbol >= nonterminals) {
+            add_terminal(follow, symbol - nonterminals, changed);
+            rest_nullable = false;
+          } else {
+            add_set(follow, result.first[symbol], changed);
+            rest_nullable = result.nullable[symbol];
+          }
+        }
+        if (rest_nullable) {
+          add_set(follow, result.follow[result.heads[p]], changed);
+        }
+      }
+    }
+  }
+
+  for (size_t n = 0; n < nonterminals; ++n) {
+    for (size_t t = 0; t < terminals; ++t) {
+      result.cells[n][t] = Result::no_production;
+    }
+  }
+  for (size_t p = 0; p < production_count; ++p) {
+    auto const head = result.heads[p];
+
+    // FIRST of the body, and the FOLLOW of its head if the body is nullable.
+    bool starts[terminals] {};
+    auto unused = false;
+    auto body_nullable = true;
+    for (size_t i = 0; i < result.body_sizes[p] && body_nullable; ++i) {
+      auto const symbol = result.body_symbols[p][i];
+      if (symbol >= nonterminals) {
+        add_terminal(starts, symbol - nonterminals, unused);
+        body_nullable = false;
+      } else {
+        add_set(starts, result.first[symbol], unused);
+        body_nullable = result.nullable[symbol];
+      }
+    }
+    if (body_nullable) {
+      add_set(starts, result.follow[head], unused);
+    }
+
+    for (size_t t = 0; t < terminals; ++t) {
+      if (!starts[t]) {
+        continue;
+      }
+      auto & cell = result.cells[head][t];
+      if (cell == Result::no_production) {
+        cell = static_cast<std::uint32_t>(p);
+      } else {
+        ++result.conflicts;
+      }
+    }
+  }
+  return result;
+}
+
+} // namespace static_grammar
+
+
+/**
+ * A predictive parsing table computed while the program is compiled, for a
+ * grammar known then.  `Static_Grammar` is a type with a static constexpr
+ * `rules()` function, for example:
+ *
+ *     struct Lists {
+ *       static constexpr auto rules()
+ *       {
+ *         using namespace static_grammar;
+ *         return static_grammar::rules(
+ *             rule("list"_ssym, "("_ssym + "items"_ssym + ")"_ssym)
+ *           , rule("items"_ssym, "atom"_ssym + "items"_ssym | Static_Symbol::empty()));
+ *       }
+ *     };
+ *
+ *     static constexpr Static_Parsing_Table<Lists> table {};
+ *
+ * Its FIRST and FOLLOW sets and table are constants, which can be queried in
+ * constant expressions, and a grammar which is not LL(1) fails to compile.
+ * `predictive_parse` takes the table in place of both a table and a grammar.
+ *
+ * Parsing needs the grammar's symbols to be interned, and its productions as
+ * `Production`s to give to visitors.  Both are made once, on first use, which
+ * is the only work done for the table when the program runs.
+ */
+template <typename Static_Grammar>
+class Static_Parsing_Table {
+  static constexpr static_grammar::Sizes sizes_ = static_grammar::measure(Static_Grammar::rules());
+
+  using Analysis = static_grammar::Analysis<sizes_.nonterminals, sizes_.terminals, sizes_.productions>;
+
+  static constexpr Analysis analysis_ = static_grammar::analyze<Analysis>(Static_Grammar::rules());
+
+  static_assert(sizes_.nonterminals > 0, "a grammar needs at least one rule");
+  static_assert(analysis_.conflicts == 0, "the grammar is not LL(1)");
+
+  /// A symbol's id, and its number in the analysis.
+  struct Id_Index {
+    Symbol::id_type id;
+    size_t index;
+
+    bool operator<(Id_Index const & other) const { return id < other.id; }
+  };
+
+  struct Interned {
+    Symbol nonterminals[sizes_.nonterminals];
+    Id_Index nonterminal_ids[sizes_.nonterminals];
+    Id_Index terminal_ids[sizes_.terminals];
+    Production productions[static_grammar::slots(sizes_.productions)];
+  };
+
+  static Interned const & interned()
+  {
+    static Interned const result = [] {
+      Interned interned;
+      for (size_t n = 0; n < sizes_.nonterminals; ++n) {
+        interned.nonterminals[n] = analysis_.nonterminals[n].symbol();
+        interned.nonterminal_ids[n] = Id_Index {interned.nonterminals[n].id(), n};
+      }
+      for (size_t t = 0; t < sizes_.terminals; ++t) {
+        interned.terminal_ids[t] = Id_Index {analysis_.terminals[t].symbol().id(), t};
+      }
+      std::sort(std::begin(interned.nonterminal_ids), std::end(interned.nonterminal_ids));
+      std::sort(std::begin(interned.terminal_ids), std::end(interned.terminal_ids));
+
+      for (size_t p = 0; p < sizes_.productions; ++p) {
+        auto const & body = analysis_.bodies[p];
+        auto & production = interned.productions[p];
+        production.first = interned.nonterminals[analysis_.heads[p]];
+        for (size_t i = 0; i < body.size(); ++i) {
+          production.second.push_back(body[i].symbol());
+        }
+      }
+      return interned;
+    }();
+    return result;
+  }
+
+  template <size_t Count>
+  static size_t find_index(Id_Index const (&ids)[Count], Symbol const & symbol)
+  {
+    auto const found = std::lower_bound(std::begin(ids), std::end(ids), Id_Index {symbol.id(), 0});
+    return found != std::end(ids) && found->id == symbol.id() ? found->index : static_grammar::no_index;
+  }
+
+public:
+  using Production_Index = std::uint32_t;
+
+  static constexpr Production_Index no_production = Analysis::no_production;
+  static constexpr size_t nonterminal_count = sizes_.nonterminals;
+  static constexpr size_t terminal_count = sizes_.terminals;
+  static constexpr size_t production_count = sizes_.productions;
+
+  /// Nonterminals in order of their first rule, starting with the start symbol.
+  static constexpr Static_Symbol nonterminal(size_t index) { return analysis_.nonterminals[index]; }
+
+  /// Terminals in order of first use, after the right end marker.
+  static constexpr Static_Symbol terminal(size_t index) { return analysis_.terminals[index]; }
+
+  /**
+   * Whether FIRST(`symbol`) contains `terminal`, which may be the empty
+   * symbol, as with `Grammar::first`.
+   */
+  static constexpr bool first_contains(Static_Symbol const & symbol, Static_Symbol const & terminal)
+  {
+    auto const n = analysis_.nonterminal_index(symbol);
+    auto const t = analysis_.terminal_index(terminal);
+    if (n == static_grammar::no_index) {
+      return symbol == terminal;
+    }
+    if (terminal == Static_Symbol::empty()) {
+      return analysis_.nullable[n];
+    }
+    return t != static_grammar::no_index && analysis_.first[n][t];
+  }
+
+  /**
+   * Whether FOLLOW(`nonterminal`) contains `terminal`.
+   */
+  static constexpr bool follow_contains(Static_Symbol const & nonterminal, Static_Symbol const & terminal)
+  {
+    auto const n = analysis_.nonterminal_index(nonterminal);
+    auto const t = analysis_.terminal_index(terminal);
+    return n != static_grammar::no_index && t != static_grammar::no_index && analysis_.follow[n][t];
+  }
+
+  static constexpr Production_Index production_index(Static_Symbol const & nonterminal, Static_Symbol const & terminal)
+  {
+    auto const n = analysis_.nonterminal_index(nonterminal);
+    auto const t = analysis_.terminal_index(terminal);
+    return n == static_grammar::no_index || t == static_grammar::no_index ? no_production : analysis_.cells[n][t];
+  }
+
+  static constexpr Static_Symbol production_head(Production_Index index) { return analysis_.nonterminals[analysis_.heads[index]]; }
+  static constexpr static_grammar::Body production_body(Production_Index index) { return analysis_.bodies[index]; }
+
+  Production_Index production_index(Symbol const & nonterminal, Symbol const & terminal) const
+  {
+    auto const n = find_index(interned().nonterminal_ids, nonterminal);
+    auto const t = find_index(interned().terminal_ids, terminal);
+    return n == static_grammar::no_index || t == static_grammar::no_index ? no_production : analysis_.cells[n][t];
+  }
+
+  Production const & production(Production_Index index) const { return interned().productions[index]; }
+
+  Symbol start_symbol() const { return interned().nonterminals[0]; }
+
+  bool is_terminal(Symbol const & symbol) const
+  {
+    return find_index(interned().nonterminal_ids, symbol) == static_grammar::no_index;
+  }
+};
+
+template <typename Static_Grammar>
+constexpr static_grammar::Sizes Static_Parsing_Table<Static_Grammar>::sizes_;
+
+template <typename Static_Grammar>
+constexpr typename Static_Parsing_Table<Static_Grammar>::Analysis Static_Parsing_Table<Static_Grammar>::analysis_;
+
+template <typename Static_Grammar>
+constexpr typename Static_Parsing_Table<Static_Grammar>::Production_Index Static_Parsing_Table<Static_Grammar>::no_production;
+
+template <typename Static_Grammar>
+constexpr size_t Static_Parsing_Table<Static_Grammar>::nonterminal_count;
+
+template <typename Static_Grammar>
+constexpr size_t Static_Parsing_Table<Static_Grammar>::terminal_count;
+
+template <typename Static_Grammar>
+constexpr size_t Static_Parsing_Table<Static_Grammar>::production_count;
+
+
+template <typename Static_Grammar>
+Production const *
+find_production(
+    Static_Parsing_Table<Static_Grammar> const & table
+  , Symbol const & nonterminal
+  , Symbol const & terminal)
+{
+  auto const index = table.production_index(nonterminal, terminal);
+  return index == Static_Parsing_Table<Static_Grammar>::no_production ? nullptr : &table.production(index);
+}
+
+
+/**
+ * Runs `predictive_parse` with a table which also stands in for its grammar.
+ */
+template <typename Static_Grammar, typename IterableTokenType, typename VisitorFunctor>
+void
+predictive_parse(
+    Static_Parsing_Table<Static_Grammar> const & table
+  , IterableTokenType & tokens
+  , VisitorFunctor & visitor)
+{
+  predictive_parse(table, table, tokens, visitor);
+}
+
+
+template <typename Static_Grammar, typename Iterable_Token_Type, typename Parse_Tree_Builder>
+auto
+predictive_parse_into_parse_tree(
+    Static_Parsing_Table<Static_Grammar> const & table
+  , Iterable_Token_Type & tokens
+  , Parse_Tree_Builder & builder)
+-> typename Parse_Tree_Builder::value_type
+{
+  return predictive_parse_into_parse_tree(table, table, tokens, builder);
+}
+
+} // namespace parka
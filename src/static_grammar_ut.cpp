@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include "grammar.hpp"
+#include "ll.hpp"
+#include "parse_tree.hpp"
+#include "static_grammar.hpp"
+#include "streams.hpp"
+#include "string.hpp"
+#include "symbol.hpp"
+using namespace parka;
+using namespace parka::static_grammar;
+
+#include "sample_grammar_test_fixtures.hpp"
+
+
+namespace {
+
+/**
+ * The grammar of `Non_Left_Recursive_Add_Multiply_Grammar_Test`.
+ */
+struct Add_Multiply {
+  static constexpr auto rules()
+  {
+    return static_grammar::rules(
+        rule("E"_ssym, "T"_ssym + "E'"_ssym)
+      , rule("E'"_ssym, "+"_ssym + "T"_ssym + "E'"_ssym | Static_Symbol::empty())
+      , rule("T"_ssym, "F"_ssym + "T'"_ssym)
+      , rule("T'"_ssym, "*"_ssym + "F"_ssym + "T'"_ssym | Static_Symbol::empty())
+      , rule("F"_ssym, "("_ssym + "E"_ssym + ")"_ssym | "id"_ssym));
+  }
+};
+
+using Add_Multiply_Table = Static_Parsing_Table<Add_Multiply>;
+
+constexpr Add_Multiply_Table add_multiply_table {};
+
+
+// The analysis and table are done during compilation.
+static_assert(Add_Multiply_Table::nonterminal_count == 5, "");
+static_assert(Add_Multiply_Table::terminal_count == 6, "");
+static_assert(Add_Multiply_Table::production_count == 8, "");
+static_assert(Add_Multiply_Table::nonterminal(0) == "E"_ssym, "");
+
+static_assert(Add_Multiply_Table::first_contains("E"_ssym, "("_ssym), "");
+static_assert(Add_Multiply_Table::first_contains("E"_ssym, "id"_ssym), "");
+static_assert(!Add_Multiply_Table::first_contains("E"_ssym, "+"_ssym), "");
+static_assert(!Add_Multiply_Table::first_contains("E"_ssym, Static_Symbol::empty()), "");
+static_assert(Add_Multiply_Table::first_contains("E'"_ssym, Static_Symbol::empty()), "");
+static_assert(Add_Multiply_Table::first_contains("+"_ssym, "+"_ssym), "");
+
+static_assert(Add_Multiply_Table::follow_contains("E"_ssym, "$"_ssym), "");
+static_assert(Add_Multiply_Table::follow_contains("E"_ssym, ")"_ssym), "");
+static_assert(Add_Multiply_Table::follow_contains("T'"_ssym, "+"_ssym), "");
+static_assert(!Add_Multiply_Table::follow_contains("T'"_ssym, "*"_ssym), "");
+
+static_assert(Add_Multiply_Table::production_head(Add_Multiply_Table::production_index("F"_ssym, "id"_ssym)) == "F"_ssym, "");
+static_assert(Add_Multiply_Table::production_body(Add_Multiply_Table::production_index("F"_ssym, "id"_ssym))[0] == "id"_ssym, "");
+static_assert(Add_Multiply_Table::production_index("F"_ssym, "+"_ssym) == Add_Multiply_Table::no_production, "");
+
+
+/**
+ * Uses the other forms of rules: single symbols and choices of symbols.
+ */
+struct Choices {
+  static constexpr auto rules()
+  {
+    return static_grammar::rules(
+        rule("S"_ssym, "A"_ssym + "B"_ssym)
+      , rule("A"_ssym, "a"_ssym | "b"_ssym)
+      , rule("B"_ssym, "c"_ssym));
+  }
+};
+
+static_assert(Static_Parsing_Table<Choices>::production_count == 4, "");
+static_assert(Static_Parsing_Table<Choices>::follow_contains("A"_ssym, "c"_ssym), "");
+static_assert(Static_Parsing_Table<Choices>::production_index("S"_ssym, "b"_ssym) == 0, "");
+
+
+/**
+ * An ambiguous grammar, which isn't LL(1), so can only be analyzed directly.
+ */
+constexpr auto ambiguous_rules()
+{
+  return static_grammar::rules(
+      rule("S"_ssym, "i"_ssym + "E"_ssym + "t"_ssym + "S"_ssym + "S'"_ssym | "a"_ssym)
+    , rule("S'"_ssym, "e"_ssym + "S"_ssym | Static_Symbol::empty())
+    , rule("E"_ssym, "b"_ssym));
+}
+
+constexpr auto ambiguous_sizes = measure(ambiguous_rules());
+
+using Ambiguous_Analysis = Analysis<ambiguous_sizes.nonterminals, ambiguous_sizes.terminals, ambiguous_sizes.productions>;
+
+static_assert(analyze<Ambiguous_Analysis>(ambiguous_rules()).conflicts == 1, "");
+
+} // namespace
+
+
+TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, Static_Analysis_Matches_Grammar) {
+  for (size_t n = 0; n < Add_Multiply_Table::nonterminal_count; ++n) {
+    auto const nonterminal = Add_Multiply_Table::nonterminal(n);
+    auto const & first = grammar.first(nonterminal.symbol());
+    auto const & follow = grammar.follow(nonterminal.symbol());
+
+    EXPECT_EQ(first.count(Symbol::empty()) != 0, Add_Multiply_Table::first_contains(nonterminal, Static_Symbol::empty()))
+      << nonterminal.symbol();
+    for (size_t t = 0; t < Add_Multiply_Table::terminal_count; ++t) {
+      auto const terminal = Add_Multiply_Table::terminal(t);
+      EXPECT_EQ(first.count(terminal.symbol()) != 0, Add_Multiply_Table::first_contains(nonterminal, terminal))
+        << nonterminal.symbol() << ' ' << terminal.symbol();
+      EXPECT_EQ(follow.count(terminal.symbol()) != 0, Add_Multiply_Table::follow_contains(nonterminal, terminal))
+        << nonterminal.symbol() << ' ' << terminal.symbol();
+    }
+  }
+}
+
+
+TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, Static_Table_Matches_Predictive_Table) {
+  Predictive_Parsing_Table parsing_table;
+  ASSERT_TRUE(create_predictive_parsing_table(grammar, &parsing_table));
+
+  size_t entries = 0;
+  for (size_t n = 0; n < Add_Multiply_Table::nonterminal_count; ++n) {
+    for (size_t t = 0; t < Add_Multiply_Table::terminal_count; ++t) {
+      auto const nonterminal = Add_Multiply_Table::nonterminal(n).symbol();
+      auto const terminal = Add_Multiply_Table::terminal(t).symbol();
+      auto const expected = find_production(parsing_table, nonterminal, terminal);
+      auto const found = find_production(add_multiply_table, nonterminal, terminal);
+      ASSERT_EQ(expected == nullptr, found == nullptr) << nonterminal << ' ' << terminal;
+      if (found != nullptr) {
+        EXPECT_EQ(*expected, *found);
+        ++entries;
+      }
+    }
+  }
+  EXPECT_EQ(parsing_table.size(), entries);
+
+  EXPECT_EQ("E"_sym, add_multiply_table.start_symbol());
+  EXPECT_TRUE(add_multiply_table.is_terminal("id"_sym));
+  EXPECT_TRUE(add_multiply_table.is_terminal("unknown"_sym));
+  EXPECT_FALSE(add_multiply_table.is_terminal("T'"_sym));
+}
+
+
+TEST_F(Non_Left_Recursive_Add_Multiply_Grammar_Test, Production_Printer_Static_Table) {
+  Predictive_Parsing_Table parsing_table;
+  ASSERT_TRUE(create_predictive_parsing_table(grammar, &parsing_table));
+
+  std::vector<Token> tokens { Token("("_sym)
+    , Token("id"_sym, "a")
+    , Token("+"_sym)
+    , Token("id"_sym, "b")
+    , Token(")"_sym)
+    , Token("*"_sym)
+    , Token("id"_sym, "c")
+    , Token(Symbol::right_end_marker())};
+
+  stringstream expected;
+  Predictive_Parse_Print_Visitor expected_visitor(expected);
+  predictive_parse(parsing_table, grammar, tokens, expected_visitor);
+
+  stringstream parse_output;
+  Predictive_Parse_Print_Visitor print_visitor(parse_output);
+  predictive_parse(add_multiply_table, tokens, print_visitor);
+  EXPECT_EQ(expected.str(), parse_output.str());
+
+  Basic_Parse_Tree_Builder builder;
+  auto const root = predictive_parse_into_parse_tree(add_multiply_table, tokens, builder);
+  ASSERT_NE(nullptr, root);
+  EXPECT_EQ("( a + b ) * c", root->yield());
+}
+
+int main(int argc, char ** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
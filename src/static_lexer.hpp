@@ -0,0 +1,628 @@
+#pragma once
+
+#include "string.hpp"
+#include "symbol.hpp"
+#include "token.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace parka {
+
+/**
+ * Building blocks of `Static_Lexer`, a lexer whose token patterns are types,
+ * so it is built entirely by the compiler.
+ *
+ * A pattern is one of:
+ *  - a byte class: `Char<'x'>`, `Range<'a', 'z'>`, `Any_Of<Classes...>`,
+ *    `None_Of<Classes...>`, or `Any` (everything but line terminators, like
+ *    `.`);
+ *  - `Text<'f', 'o', 'r'>`, matching those characters in order;
+ *  - `Seq<Patterns...>`, `Alt<Patterns...>`, `Star<P>`, `Plus<P>` and `Opt<P>`,
+ *    as `PQ`, `P|Q`, `P*`, `P+` and `P?` in a regular expression.
+ *
+ * At the top of a rule, `Bounded<P>` requires a word boundary after the match,
+ * like `P\b`, and `Keyword<'f', 'o', 'r'>` is short for `Bounded<Text<...>>`.
+ *
+ * Patterns become a Glushkov automaton, which has one position for each byte
+ * class in the patterns and needs no epsilon transitions.  Its tables are
+ * computed in constexpr functions, so they are constants in the program, and
+ * matching is a loop over bit masks of active positions.
+ */
+namespace static_lexer {
+
+/**
+ * Membership set over all values of a byte, usable in constant expressions.
+ */
+struct Byte_Mask {
+  std::uint64_t words[4] {};
+
+  constexpr bool contains(unsigned char byte) const
+  {
+    return ((words[byte / 64] >> (byte % 64)) & 1u) != 0;
+  }
+};
+
+
+constexpr Byte_Mask
+byte_range(unsigned first, unsigned last)
+{
+  Byte_Mask result {};
+  for (auto byte = first; byte <= last; ++byte) {
+    result.words[byte / 64] |= std::uint64_t {1} << (byte % 64);
+  }
+  return result;
+}
+
+
+constexpr Byte_Mask
+operator|(Byte_Mask const & lhs, Byte_Mask const & rhs)
+{
+  Byte_Mask result {};
+  for (size_t i = 0; i < 4; ++i) {
+    result.words[i] = lhs.words[i] | rhs.words[i];
+  }
+  return result;
+}
+
+
+constexpr Byte_Mask
+operator~(Byte_Mask const & mask)
+{
+  Byte_Mask result {};
+  for (size_t i = 0; i < 4; ++i) {
+    result.words[i] = ~mask.words[i];
+  }
+  return result;
+}
+
+
+constexpr size_t
+lowest_bit(std::uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<size_t>(__builtin_ctzll(word));
+#else
+  size_t bit = 0;
+  while ((word & 1u) == 0) {
+    word >>= 1;
+    ++bit;
+  }
+  return bit;
+#endif
+}
+
+
+/**
+ * Set of automaton positions, as a fixed number of 64 bit words.
+ */
+template <size_t Words>
+struct Position_Set {
+  std::uint64_t words[Words] {};
+
+  constexpr void set(size_t position) { words[position / 64] |= std::uint64_t {1} << (position % 64); }
+  constexpr bool test(size_t position) const { return ((words[position / 64] >> (position % 64)) & 1u) != 0; }
+
+  constexpr bool any() const
+  {
+    for (size_t i = 0; i < Words; ++i) {
+      if (words[i] != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// The lowest position at or after `from`, or `size_t(-1)` if none.
+  constexpr size_t next(size_t from) const
+  {
+    for (auto i = from / 64; i < Words; ++i) {
+      auto word = words[i];
+      if (i == from / 64) {
+        word &= ~std::uint64_t {0} << (from % 64);
+      }
+      if (word != 0) {
+        return i * 64 + lowest_bit(word);
+      }
+    }
+    return static_cast<size_t>(-1);
+  }
+
+  constexpr Position_Set & operator|=(Position_Set const & other)
+  {
+    for (size_t i = 0; i < Words; ++i) {
+      words[i] |= other.words[i];
+    }
+    return *this;
+  }
+
+  constexpr Position_Set operator&(Position_Set const & other) const
+  {
+    Position_Set result {};
+    for (size_t i = 0; i < Words; ++i) {
+      result.words[i] = words[i] & other.words[i];
+    }
+    return result;
+  }
+};
+
+
+constexpr size_t
+words_for(size_t positions)
+{
+  return positions == 0 ? 1 : (positions + 63) / 64;
+}
+
+
+/**
+ * The constant tables of an automaton with `Positions` positions.
+ */
+template <size_t Positions>
+struct Tables {
+  static constexpr size_t words = words_for(Positions);
+  static constexpr size_t slots = Positions == 0 ? 1 : Positions;
+  using Set = Position_Set<words>;
+
+  Byte_Mask bytes[slots] {};
+  Set follow[slots] {};
+  size_t rule_of[slots] {};
+
+  Set start {};
+  Set accepting {};
+  Set bounded {};
+
+  // Positions whose byte class contains each byte.
+  Set by_byte[256] {};
+};
+
+
+/**
+ * First and last positions of a pattern, and whether it matches the empty
+ * string.
+ */
+template <size_t Words>
+struct Fragment {
+  Position_Set<Words> first {};
+  Position_Set<Words> last {};
+  bool nullable = false;
+};
+
+
+/**
+ * Adds `follow` to the positions following each of `last`, which are all
+ * within [begin, end).
+ */
+template <typename Table>
+constexpr void
+connect(Table & tables, typename Table::Set const & last, typename Table::Set const & follow, size_t begin, size_t end)
+{
+  for (auto position = begin; position < end; ++position) {
+    if (last.test(position)) {
+      tables.follow[position] |= follow;
+    }
+  }
+}
+
+
+/**
+ * Base of byte class patterns, which are a single position.
+ */
+template <typename Class>
+struct Byte_Class {
+  static constexpr size_t positions = 1;
+
+  template <typename Table>
+  static constexpr Fragment<Table::words> build(Table & tables, size_t offset)
+  {
+    tables.bytes[offset] = Class::bytes();
+    Fragment<Table::words> result {};
+    result.first.set(offset);
+    result.last.set(offset);
+    return result;
+  }
+};
+
+
+template <unsigned char First, unsigned char Last>
+struct Range : Byte_Class<Range<First, Last>> {
+  static constexpr Byte_Mask bytes() { return byte_range(First, Last); }
+};
+
+
+template <char_type C>
+struct Char : Range<static_cast<unsigned char>(C), static_cast<unsigned char>(C)> {};
+
+
+template <typename... Classes>
+struct Any_Of;
+
+template <>
+struct Any_Of<> : Byte_Class<Any_Of<>> {
+  static constexpr Byte_Mask bytes() { return Byte_Mask {}; }
+};
+
+template <typename Class, typename... Rest>
+struct Any_Of<Class, Rest...> : Byte_Class<Any_Of<Class, Rest...>> {
+  static constexpr Byte_Mask bytes() { return Class::bytes() | Any_Of<Rest...>::bytes(); }
+};
+
+
+template <typename... Classes>
+struct None_Of : Byte_Class<None_Of<Classes...>> {
+  static constexpr Byte_Mask bytes() { return ~Any_Of<Classes...>::bytes(); }
+};
+
+
+using Any = None_Of<Char<'\n'>, Char<'\r'>>;
+using Digit = Range<'0', '9'>;
+using Word_Char = Any_Of<Range<'a', 'z'>, Range<'A', 'Z'>, Digit, Char<'_'>>;
+
+
+template <typename... Patterns>
+struct Seq;
+
+template <>
+struct Seq<> {
+  static constexpr size_t positions = 0;
+
+  template <typename Table>
+  static constexpr Fragment<Table::words> build(Table &, size_t)
+  {
+    Fragment<Table::words> result {};
+    result.nullable = true;
+    return result;
+  }
+};
+
+template <typename Pattern, typename... Rest>
+struct Seq<Pattern, Rest...> {
+  static constexpr size_t positions = Pattern::positions + Seq<Rest...>::positions;
+
+  template <typename Table>
+  static constexpr Fragment<Table::words> build(Table & tables, size_t offset)
+  {
+    auto const head = Pattern::build(tables, offset);
+    auto const tail = Seq<Rest...>::build(tables, offset + Pattern::positions);
+    connect(tables, head.last, tail.first, offset, offset + Pattern::positions);
+
+    auto result = head;
+    if (head.nullable) {
+      result.first |= tail.first;
+    }
+    result.last = tail.last;
+    if (tail.nullable) {
+      result.last |= head.last;
+    }
+    result.nullable = head.nullable && tail.nullable;
+    return result;
+  }
+};
+
+
+template <typename... Patterns>
+struct Alt;
+
+template <>
+struct Alt<> {
+  static constexpr size_t positions = 0;
+
+  template <typename Table>
+  static constexpr Fragment<Table::words> build(Table &, size_t)
+  {
+    return Fragment<Table::words> {};
+  }
+};
+
+template <typename Pattern, typename... Rest>
+struct Alt<Pattern, Rest...> {
+  static constexpr size_t positions = Pattern::positions + Alt<Rest...>::positions;
+
+  template <typename Table>
+  static constexpr Fragment<Table::words> build(Table & tables, size_t offset)
+  {
+    auto result = Pattern::build(tables, offset);
+    auto const rest = Alt<Rest...>::build(tables, offset + Pattern::positions);
+    result.first |= rest.first;
+    result.last |= rest.last;
+    result.nullable = result.nullable || rest.nullable;
+    return result;
+  }
+};
+
+
+template <typename Pattern>
+struct Plus {
+  static constexpr size_t positions = Pattern::positions;
+
+  template <typename Table>
+  static constexpr Fragment<Table::words> build(Table & tables, size_t offset)
+  {
+    auto const result = Pattern::build(tables, offset);
+    connect(tables, result.last, result.first, offset, offset + positions);
+    return result;
+  }
+};
+
+
+template <typename Pattern>
+struct Opt {
+  static constexpr size_t positions = Pattern::positions;
+
+  template <typename Table>
+  static constexpr Fragment<Table::words> build(Table & tables, size_t offset)
+  {
+    auto result = Pattern::build(tables, offset);
+    result.nullable = true;
+    return result;
+  }
+};
+
+
+template <typename Pattern>
+struct Star : Opt<Plus<Pattern>> {};
+
+
+template <char_type... Cs>
+struct Text : Seq<Char<Cs>...> {};
+
+
+/**
+ * A rule's pattern, which only matches if followed by a word boundary.
+ */
+template <typename Pattern>
+struct Bounded : Pattern {};
+
+
+template <char_type... Cs>
+using Keyword = Bounded<Text<Cs...>>;
+
+
+template <typename Pattern>
+struct Is_Bounded {
+  static constexpr bool value = false;
+};
+
+template <typename Pattern>
+struct Is_Bounded<Bounded<Pattern>> {
+  static constexpr bool value = true;
+};
+
+
+/**
+ * The combined automaton of a list of rules, each of which has a `pattern`
+ * type and a static `name()` function.
+ */
+template <typename... Rules>
+struct Rule_List;
+
+template <>
+struct Rule_List<> {
+  static constexpr size_t positions = 0;
+
+  template <typename Table>
+  static constexpr void build(Table &, size_t, size_t)
+  {
+  }
+};
+
+template <typename Rule, typename... Rest>
+struct Rule_List<Rule, Rest...> {
+  using Pattern = typename Rule::pattern;
+  static constexpr size_t positions = Pattern::positions + Rule_List<Rest...>::positions;
+
+  template <typename Table>
+  static constexpr void build(Table & tables, size_t offset, size_t rule)
+  {
+    auto const fragment = Pattern::build(tables, offset);
+    tables.start |= fragment.first;
+    tables.accepting |= fragment.last;
+    for (auto position = offset; position < offset + Pattern::positions; ++position) {
+      tables.rule_of[position] = rule;
+      if (Is_Bounded<Pattern>::value) {
+        tables.bounded.set(position);
+      }
+    }
+    Rule_List<Rest...>::build(tables, offset + Pattern::positions, rule + 1);
+  }
+};
+
+
+template <typename Rules>
+constexpr Tables<Rules::positions>
+build_tables()
+{
+  Tables<Rules::positions> tables {};
+  Rules::build(tables, 0, 0);
+  for (unsigned byte = 0; byte < 256; ++byte) {
+    for (size_t position = 0; position < Rules::positions; ++position) {
+      if (tables.bytes[position].contains(static_cast<unsigned char>(byte))) {
+        tables.by_byte[byte].set(position);
+      }
+    }
+  }
+  return tables;
+}
+
+
+constexpr bool
+is_word_byte(char_type ch)
+{
+  return Word_Char::bytes().contains(static_cast<unsigned char>(ch));
+}
+
+
+using Whitespace = Any_Of<Char<' '>, Char<'\t'>, Char<'\r'>, Char<'\n'>>;
+
+} // namespace static_lexer
+
+
+/**
+ * A token from a `Static_Lexer`, identified by the index of its rule.
+ */
+struct Static_Token {
+  size_t rule;
+  Lexeme_View lexeme;
+};
+
+
+/**
+ * A lexer for a token set fixed at compile time.  Each rule is a type with a
+ * `pattern` (see `static_lexer`) and a static `name()` giving its token's
+ * symbol, for example:
+ *
+ *     struct Identifier {
+ *       using pattern = Seq<Any_Of<Range<'a', 'z'>, Char<'_'>>, Star<Word_Char>>;
+ *       static char const * name() { return "identifier"; }
+ *     };
+ *
+ *     Static_Lexer<For_Keyword, Identifier> lexer(data, size);
+ *
+ * Rules are matched as by `Lexer`: the first rule which matches wins, with its
+ * longest match, and empty matches are never reported.  Bytes in `Ignored`
+ * are skipped between tokens, and bytes no rule matches are skipped too.
+ *
+ * Unlike `Lexer`, there are no regex objects, and nothing is compiled when the
+ * program runs: the automaton's tables are constants, and `match` can even be
+ * evaluated at compile time.  The input is not copied, so must outlive the
+ * tokens, like `Lexer::lex_borrowed`.
+ */
+template <typename Ignored, typename... Rules>
+class Basic_Static_Lexer {
+  static_assert(sizeof...(Rules) > 0, "a lexer needs at least one rule");
+
+  using Rule_Set = static_lexer::Rule_List<Rules...>;
+  using Automaton = static_lexer::Tables<Rule_Set::positions>;
+
+  static constexpr Automaton tables_ = static_lexer::build_tables<Rule_Set>();
+
+  char_type const * current_;
+  char_type const * end_;
+  Static_Token next_;
+  bool has_next_;
+
+public:
+  static constexpr size_t rule_count = sizeof...(Rules);
+  static constexpr size_t no_match = static_cast<size_t>(-1);
+
+  struct Match {
+    size_t rule;
+    size_t length;
+  };
+
+  Basic_Static_Lexer() : current_(nullptr), end_(nullptr), next_ {no_match, Lexeme_View()}, has_next_(false) {}
+
+  Basic_Static_Lexer(char_type const * data, size_t size) : Basic_Static_Lexer()
+  {
+    lex_borrowed(data, size);
+  }
+
+  /**
+   * Lexes new input, discarding anything left of the previous input.
+   */
+  void lex_borrowed(char_type const * data, size_t size)
+  {
+    current_ = data;
+    end_ = data + size;
+    has_next_ = false;
+  }
+
+  /**
+   * Finds the first rule matching a prefix of [begin, end), and the length of
+   * its longest match.
+   */
+  static constexpr Match match(char_type const * begin, char_type const * end)
+  {
+    Match best {no_match, 0};
+    auto reach = tables_.start;
+    for (auto current = begin; current != end;) {
+      auto const active = reach & tables_.by_byte[static_cast<unsigned char>(*current)];
+      if (!active.any()) {
+        break;
+      }
+      ++current;
+
+      auto const accepted = active & tables_.accepting;
+      for (auto position = accepted.next(0); position != static_cast<size_t>(-1); position = accepted.next(position + 1)) {
+        auto const rule = tables_.rule_of[position];
+        if (rule > best.rule) {
+          break;
+        }
+        if (tables_.bounded.test(position)) {
+          auto const next_is_word = current != end && static_lexer::is_word_byte(*current);
+          if (static_lexer::is_word_byte(current[-1]) == next_is_word) {
+            continue;
+          }
+        }
+        best = {rule, static_cast<size_t>(current - begin)};
+        break;
+      }
+
+      reach = typename Automaton::Set {};
+      for (auto position = active.next(0); position != static_cast<size_t>(-1); position = active.next(position + 1)) {
+        reach |= tables_.follow[position];
+      }
+    }
+    return best;
+  }
+
+  bool has_next_token()
+  {
+    while (!has_next_ && current_ != end_) {
+      if (Ignored::bytes().contains(static_cast<unsigned char>(*current_))) {
+        ++current_;
+        continue;
+      }
+      auto const found = match(current_, end_);
+      if (found.rule == no_match) {
+        // TODO: Report an error, as in Lexer.
+        ++current_;
+        continue;
+      }
+      next_ = Static_Token {found.rule, Lexeme_View(current_, found.length)};
+      current_ += found.length;
+      has_next_ = true;
+    }
+    return has_next_;
+  }
+
+  Static_Token next()
+  {
+    has_next_token();
+    has_next_ = false;
+    return next_;
+  }
+
+  Token_View next_token_view()
+  {
+    auto const token = next();
+    return Token_View(rule_symbol(token.rule), token.lexeme);
+  }
+
+  Token next_token() { return Token(next_token_view()); }
+
+  static Symbol const & rule_symbol(size_t rule)
+  {
+    static Symbol const symbols[] = {Symbol(Rules::name())...};
+    return symbols[rule];
+  }
+
+  static constexpr size_t position_count() { return Rule_Set::positions; }
+};
+
+template <typename Ignored, typename... Rules>
+constexpr typename Basic_Static_Lexer<Ignored, Rules...>::Automaton Basic_Static_Lexer<Ignored, Rules...>::tables_;
+
+template <typename Ignored, typename... Rules>
+constexpr size_t Basic_Static_Lexer<Ignored, Rules...>::rule_count;
+
+template <typename Ignored, typename... Rules>
+constexpr size_t Basic_Static_Lexer<Ignored, Rules...>::no_match;
+
+
+/**
+ * A `Basic_Static_Lexer` ignoring the same whitespace as `Lexer`.
+ */
+template <typename... Rules>
+using Static_Lexer = Basic_Static_Lexer<static_lexer::Whitespace, Rules...>;
+
+} // namespace parka
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include "lexer.hpp"
+#include "static_lexer.hpp"
+#include "string.hpp"
+#include "token_range.hpp"
+
+#include <random>
+#include <vector>
+using namespace parka;
+using namespace parka::static_lexer;
+
+
+namespace {
+
+struct For_Keyword {
+  using pattern = Keyword<'f', 'o', 'r'>;
+  static char const * name() { return "for"; }
+};
+
+struct In_Keyword {
+  using pattern = Keyword<'i', 'n'>;
+  static char const * name() { return "in"; }
+};
+
+struct Identifier {
+  using pattern = Seq<Any_Of<Range<'a', 'z'>, Range<'A', 'Z'>, Char<'_'>>, Star<Word_Char>>;
+  static char const * name() { return "identifier"; }
+};
+
+struct Integer {
+  using pattern = Seq<Opt<Char<'-'>>, Alt<Seq<Range<'1', '9'>, Star<Digit>>, Char<'0'>>>;
+  static char const * name() { return "integer"; }
+};
+
+struct Quoted_String {
+  using pattern = Seq<Char<'"'>, Star<Alt<None_Of<Char<'"'>, Char<'\\'>>, Seq<Char<'\\'>, Any>>>, Char<'"'>>;
+  static char const * name() { return "quoted_string"; }
+};
+
+struct Arrow {
+  using pattern = Text<'-', '>'>;
+  static char const * name() { return "->"; }
+};
+
+struct Minus {
+  using pattern = Char<'-'>;
+  static char const * name() { return "-"; }
+};
+
+using Test_Lexer = Static_Lexer<For_Keyword, In_Keyword, Identifier, Integer, Quoted_String, Arrow, Minus>;
+
+
+constexpr Test_Lexer::Match
+match(char const * text, size_t size)
+{
+  return Test_Lexer::match(text, text + size);
+}
+
+// The automaton is built, and can match, during compilation.
+static_assert(Test_Lexer::position_count() == 3 + 2 + 2 + 4 + 5 + 2 + 1, "one position per byte class");
+static_assert(match("for x", 5).rule == 0 && match("for x", 5).length == 3, "keyword");
+static_assert(match("format", 6).rule == 2 && match("format", 6).length == 6, "keyword prefix");
+static_assert(match("-12", 3).rule == 3 && match("-12", 3).length == 3, "integer");
+static_assert(match("->", 2).rule == 5, "arrow");
+static_assert(match("?", 1).rule == Test_Lexer::no_match, "no match");
+
+
+void
+configure(Lexer & lexer)
+{
+  lexer.register_keyword("for");
+  lexer.register_keyword("in");
+  lexer.register_pattern_for_token("[a-zA-Z_][a-zA-Z_0-9]*", "identifier");
+  lexer.register_pattern_for_token("(-)?([1-9][0-9]*|0)", "integer");
+  lexer.register_pattern_for_token("\"([^\"\\\\]|(\\\\.))*\"", "quoted_string");
+  lexer.register_pattern_for_token("->", "->");
+  lexer.register_pattern_for_token("-", "-");
+}
+
+} // namespace
+
+
+TEST(Static_Lexer_Test, Tokens) {
+  string const input = "for x in range(0, -10) \"in \\\"quotes\\\"\" forin in2 007 -x ->";
+  Test_Lexer lexer(input.data(), input.size());
+
+  std::vector<std::pair<string, string>> expected = {
+    {"for", "for"}, {"identifier", "x"}, {"in", "in"}, {"identifier", "range"}, {"integer", "0"},
+    {"integer", "-10"}, {"quoted_string", "\"in \\\"quotes\\\"\""}, {"identifier", "forin"},
+    {"identifier", "in2"}, {"integer", "0"}, {"integer", "0"}, {"integer", "7"}, {"-", "-"},
+    {"identifier", "x"}, {"->", "->"}};
+  for (auto const & name_lexeme : expected) {
+    ASSERT_TRUE(lexer.has_next_token());
+    auto const token = lexer.next_token();
+    EXPECT_EQ(name_lexeme.first, token.symbol.repr());
+    EXPECT_EQ(name_lexeme.second, token.lexeme);
+  }
+  EXPECT_FALSE(lexer.has_next_token());
+}
+
+
+TEST(Static_Lexer_Test, Matches_Lexer) {
+  std::vector<string> const pieces = {"for", "in", "x", "_", "1", "0", "-", ">", " ", "\n", "\"", "\\", "?", "("};
+  std::mt19937 random(11);
+  for (size_t trial = 0; trial < 200; ++trial) {
+    string input;
+    for (auto count = random() % 60; count > 0; --count) {
+      input += pieces[random() % pieces.size()];
+    }
+
+    Lexer lexer;
+    configure(lexer);
+    lexer.lex_borrowed(input.data(), input.size());
+    Test_Lexer static_lexer(input.data(), input.size());
+
+    while (lexer.has_next_token()) {
+      ASSERT_TRUE(static_lexer.has_next_token()) << input;
+      auto const expected = lexer.next_token_view();
+      auto const actual = static_lexer.next_token_view();
+      EXPECT_EQ(expected.symbol, actual.symbol) << input;
+      EXPECT_EQ(expected.lexeme.data(), actual.lexeme.data()) << input;
+      EXPECT_EQ(expected.lexeme.size(), actual.lexeme.size()) << input;
+    }
+    EXPECT_FALSE(static_lexer.has_next_token()) << input;
+  }
+}
+
+
+TEST(Static_Lexer_Test, Token_Range) {
+  string const input = "for x";
+  Test_Lexer lexer(input.data(), input.size());
+  std::vector<Symbol> symbols;
+  for (auto const & token : token_range(lexer)) {
+    symbols.push_back(token.symbol);
+  }
+  EXPECT_EQ((std::vector<Symbol> {"for"_sym, "identifier"_sym, Symbol::right_end_marker()}), symbols);
+}
@@ -56,4 +56,11 @@ ostream & operator<<(
   return output_separated_elements(os, symbol_set, " ");
 }
 
+ostream & operator<<(
+  ostream & os,
+  Lexeme_View const & lexeme)
+{
+  return os.write(lexeme.data(), static_cast<std::streamsize>(lexeme.size()));
+}
+
 } // namespace parka
@@ -2,6 +2,7 @@
 
 #include "string.hpp"
 #include "symbol.hpp"
+#include "token.hpp"
 
 #include <iostream>
 #include <sstream>
@@ -46,5 +47,6 @@ string as_string(T const & value) {
 ostream & operator<<(ostream & os, Symbol_String const & symbol_string);
 ostream & operator<<(ostream & os, vector<Symbol_String> const & symbol_string_vec);
 ostream & operator<<(ostream & os, Symbol_Set const & symbol_set);
+ostream & operator<<(ostream & os, Lexeme_View const & lexeme);
 
 } // namespace parka
@@ -1,16 +1,106 @@
 #include "symbol.hpp"
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
 namespace parka {
 
-Symbol
-Symbol::empty() {
-  return Symbol("empty");
+constexpr Symbol::id_type Symbol::empty_id;
+constexpr Symbol::id_type Symbol::right_end_marker_id;
+
+namespace {
+
+/**
+ * Names of all symbols, indexed by id.  Names are kept in segments which
+ * double in size and never move, so `repr` can read them without locking
+ * while other threads intern new names.
+ */
+class Symbol_Table {
+  static constexpr size_t first_segment_bits = 8;
+  static constexpr size_t segment_count = 32 - first_segment_bits + 1;
+
+  std::mutex mutex_;
+  std::unordered_map<string, Symbol::id_type> ids_;
+  std::atomic<string *> segments_[segment_count];
+  std::unique_ptr<string[]> owned_segments_[segment_count];
+  Symbol::id_type size_;
+
+  // Segment s holds ids [2^(s+8) - 2^8, 2^(s+9) - 2^8).
+  static size_t segment_of(std::uint64_t id, size_t * index)
+  {
+    auto const biased = id + (std::uint64_t {1} << first_segment_bits);
+    size_t bits = 0;
+    while ((biased >> (bits + 1)) != 0) {
+      ++bits;
+    }
+    *index = static_cast<size_t>(biased - (std::uint64_t {1} << bits));
+    return bits - first_segment_bits;
+  }
+
+public:
+  Symbol_Table() : size_(0)
+  {
+    for (auto & segment : segments_) {
+      segment.store(nullptr, std::memory_order_relaxed);
+    }
+    intern("empty");
+    intern("$");
+  }
+
+  Symbol::id_type intern(string const & name)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto const found = ids_.find(name);
+    if (found != ids_.end()) {
+      return found->second;
+    }
+
+    auto const id = size_;
+    size_t index = 0;
+    auto const segment = segment_of(id, &index);
+    if (!owned_segments_[segment]) {
+      owned_segments_[segment].reset(new string[size_t {1} << (segment + first_segment_bits)]);
+    }
+    owned_segments_[segment][index] = name;
+    segments_[segment].store(owned_segments_[segment].get(), std::memory_order_release);
+
+    ids_.emplace(name, id);
+    ++size_;
+    return id;
+  }
+
+  string const & name(Symbol::id_type id) const
+  {
+    size_t index = 0;
+    auto const segment = segment_of(id, &index);
+    return segments_[segment].load(std::memory_order_acquire)[index];
+  }
+};
+
+
+Symbol_Table &
+symbol_table()
+{
+  static Symbol_Table table;
+  return table;
 }
 
+} // namespace
 
-Symbol
-Symbol::right_end_marker() {
-  return Symbol("$");
+
+Symbol::Symbol(string const & repr)
+  : id_(symbol_table().intern(repr))
+{
+}
+
+
+string const &
+Symbol::repr() const
+{
+  return symbol_table().name(id_);
 }
 
 
@@ -26,28 +116,89 @@ operator"" _sym(char const * symbol, size_t) {
   return Symbol(symbol);
 }
 
+Symbol_String
+operator+(Symbol const & lhs, Symbol const & rhs) {
+  // Most bodies are short, so leave room for a few more symbols to be
+  // appended without reallocating.
+  Symbol_String result;
+  result.reserve(4);
+  result.push_back(lhs);
+  result.push_back(rhs);
+  return result;
+}
+
+Symbol_String
+operator+(Symbol_String const & lhs, Symbol const & rhs) {
+  Symbol_String result;
+  result.reserve(lhs.size() + 1);
+  result.insert(result.end(), lhs.begin(), lhs.end());
+  result.push_back(rhs);
+  return result;
+}
+
+Symbol_String
+operator+(Symbol_String && lhs, Symbol const & rhs) {
+  lhs.push_back(rhs);
+  return std::move(lhs);
+}
+
+Symbol_String
+operator+(Symbol const & lhs, Symbol_String const & rhs) {
+  Symbol_String result;
+  result.reserve(rhs.size() + 1);
+  result.push_back(lhs);
+  result.insert(result.end(), rhs.begin(), rhs.end());
+  return result;
+}
+
 Symbol_String
 operator+(Symbol_String const & lhs, Symbol_String const & rhs) {
-  Symbol_String result(lhs);
+  Symbol_String result;
+  result.reserve(lhs.size() + rhs.size());
+  result.insert(result.end(), lhs.begin(), lhs.end());
   result.insert(result.end(), rhs.begin(), rhs.end());
   return result;
 }
 
+Symbol_String
+operator+(Symbol_String && lhs, Symbol_String const & rhs) {
+  lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+  return std::move(lhs);
+}
+
 
 // Alternatives
 Symbol_String_Alternatives
 operator|(Symbol_String const & lhs, Symbol_String const & rhs) {
   Symbol_String_Alternatives result;
+  result.reserve(2);
   result.push_back(lhs);
   result.push_back(rhs);
   return result;
 }
 
+Symbol_String_Alternatives
+operator|(Symbol_String && lhs, Symbol_String && rhs) {
+  Symbol_String_Alternatives result;
+  result.reserve(4);
+  result.push_back(std::move(lhs));
+  result.push_back(std::move(rhs));
+  return result;
+}
+
 Symbol_String_Alternatives
 operator|(Symbol_String_Alternatives const & lhs, Symbol_String const & rhs) {
-  Symbol_String_Alternatives result(lhs);
+  Symbol_String_Alternatives result;
+  result.reserve(lhs.size() + 1);
+  result.insert(result.end(), lhs.begin(), lhs.end());
   result.push_back(rhs);
   return result;
 }
 
+Symbol_String_Alternatives
+operator|(Symbol_String_Alternatives && lhs, Symbol_String && rhs) {
+  lhs.push_back(std::move(rhs));
+  return std::move(lhs);
+}
+
 } // namespace parka
@@ -2,6 +2,8 @@
 
 #include "string.hpp"
 
+#include <cstdint>
+#include <functional>
 #include <set>
 #include <vector>
 
@@ -17,35 +19,59 @@ using Symbol_Pair = std::pair<Symbol, Symbol>;
 
 /**
  * A lightweight, immutable symbol type.
+ *
+ * Symbols are interned: each distinct name is stored once in a global table,
+ * and a Symbol is only its 32 bit index there.  Comparing and hashing are
+ * therefore O(1), and copying a Symbol never allocates.  Symbols are ordered by
+ * when their names were first interned, not alphabetically.
+ *
+ * The empty symbol and right end marker have reserved ids, so need no lookup.
+ * Interning is thread safe.
  */
 class Symbol {
-  string repr_;
-
 public:
-  explicit Symbol(string repr="empty")
-    : repr_(repr)
-  {
-  }
+  using id_type = std::uint32_t;
+
+  static constexpr id_type empty_id = 0;
+  static constexpr id_type right_end_marker_id = 1;
+
+  Symbol() : id_(empty_id) {}
+  explicit Symbol(string const & repr);
 
   /**
    * The "empty" (epsilon) symbol.
    */
-  static Symbol empty();
+  static Symbol empty() { return from_id(empty_id); }
 
   /**
    * Typically denoted "$"
    */
-  static Symbol right_end_marker();
+  static Symbol right_end_marker() { return from_id(right_end_marker_id); }
+
+  /**
+   * The symbol with an id previously given by `id()`.
+   */
+  static Symbol from_id(id_type id)
+  {
+    Symbol result;
+    result.id_ = id;
+    return result;
+  }
 
-  string repr() const { return repr_; }
+  id_type id() const { return id_; }
+
+  /**
+   * The symbol's name, which stays valid for the life of the program.
+   */
+  string const & repr() const;
 
   // "Less than" for use in std::set and std::map
   bool operator<(Symbol const & other) const {
-      return repr_ < other.repr_;
+      return id_ < other.id_;
   }
 
   bool operator==(Symbol const & other) const {
-    return repr_ == other.repr_;
+    return id_ == other.id_;
   }
 
   bool operator!=(Symbol const & other) const {
@@ -60,15 +86,38 @@ public:
    * Symbol types for | and + operators.
    */
   operator Symbol_String() const;
+
+private:
+  id_type id_;
 };
 
 
 // In line creation of grammar helpers.
+//
+// The overloads taking rvalues append to their left operand rather than
+// copying it, so a chain such as `a + b + c | d + e` builds each body and the
+// list of alternatives in place, instead of copying them at every operator.
 Symbol operator"" _sym(char const * symbol, size_t);
+Symbol_String operator+(Symbol const & lhs, Symbol const & rhs);
+Symbol_String operator+(Symbol_String const & lhs, Symbol const & rhs);
+Symbol_String operator+(Symbol_String && lhs, Symbol const & rhs);
+Symbol_String operator+(Symbol const & lhs, Symbol_String const & rhs);
 Symbol_String operator+(Symbol_String const & lhs, Symbol_String const & rhs);
+Symbol_String operator+(Symbol_String && lhs, Symbol_String const & rhs);
 Symbol_String_Alternatives operator|(Symbol_String const & lhs, Symbol_String const & rhs);
-Symbol_String_Alternatives operator|(Symbol_String_Alternatives const & lhs, Symbol_String const & rhs)
-  ;
+Symbol_String_Alternatives operator|(Symbol_String && lhs, Symbol_String && rhs);
+Symbol_String_Alternatives operator|(Symbol_String_Alternatives const & lhs, Symbol_String const & rhs);
+Symbol_String_Alternatives operator|(Symbol_String_Alternatives && lhs, Symbol_String && rhs);
 
 
 } // namespace parka
+
+
+namespace std {
+
+template <>
+struct hash<parka::Symbol> {
+  size_t operator()(parka::Symbol const & symbol) const { return symbol.id(); }
+};
+
+} // namespace std
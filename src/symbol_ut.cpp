@@ -2,6 +2,10 @@
 
 #include "symbol.hpp"
 #include "streams.hpp"
+
+#include <functional>
+#include <thread>
+#include <vector>
 using namespace parka;
 
 TEST(First_Test, Examples) {
@@ -22,7 +26,82 @@ TEST(First_Test, Examples) {
   ASSERT_EQ("+ T E' | empty", as_string("+"_sym + t + e_ | empty));
   ASSERT_EQ("F T'", as_string(f + t_));
   ASSERT_EQ("* F T' | empty", as_string("*"_sym + f + t_ | empty));
-  ASSERT_EQ("( E ) | id", as_string("("_sym + e + ")"_sym | "id"_sym));
+  ASSERT_EQ("( E ) | id", as_string("("_sym + e + ")"_sym | identifier));
+}
+
+TEST(Symbol_Test, Interned) {
+  auto const a = "interned_a"_sym;
+  auto const b = Symbol("interned_b");
+  EXPECT_EQ(a, Symbol("interned_a"));
+  EXPECT_EQ(a.id(), Symbol("interned_a").id());
+  EXPECT_NE(a, b);
+  EXPECT_EQ(a, Symbol::from_id(a.id()));
+  EXPECT_EQ(std::hash<Symbol>()(a), std::hash<Symbol>()("interned_a"_sym));
+
+  // Names are stored once, and stay where they are as more are added.
+  auto const & name = a.repr();
+  EXPECT_EQ(&name, &Symbol("interned_a").repr());
+  for (size_t i = 0; i < 1000; ++i) {
+    Symbol("interned_" + std::to_string(i));
+  }
+  EXPECT_EQ(&name, &a.repr());
+  EXPECT_EQ("interned_a", name);
+  EXPECT_EQ("interned_999", Symbol("interned_999").repr());
+}
+
+
+TEST(Symbol_Test, Reserved) {
+  EXPECT_EQ(Symbol::empty_id, Symbol::empty().id());
+  EXPECT_EQ(Symbol::right_end_marker_id, Symbol::right_end_marker().id());
+  EXPECT_EQ(Symbol::empty(), Symbol());
+  EXPECT_EQ(Symbol::right_end_marker(), "$"_sym);
+  EXPECT_EQ("empty", Symbol::empty().repr());
+  EXPECT_EQ("$", Symbol::right_end_marker().repr());
+}
+
+
+TEST(Symbol_Test, Concurrent_Interning) {
+  std::vector<std::thread> threads;
+  std::vector<std::vector<Symbol>> symbols(4);
+  for (size_t t = 0; t < symbols.size(); ++t) {
+    threads.emplace_back([&symbols, t]() {
+      for (size_t i = 0; i < 2000; ++i) {
+        symbols[t].push_back(Symbol("concurrent_" + std::to_string(i)));
+        EXPECT_EQ("concurrent_" + std::to_string(i), symbols[t].back().repr());
+      }
+    });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  for (auto const & each : symbols) {
+    EXPECT_EQ(symbols[0], each);
+  }
+}
+
+TEST(Symbol_Test, Builders_Append_In_Place) {
+  auto body = "a"_sym + "b"_sym;
+  auto const * data = body.data();
+  body = std::move(body) + "c"_sym + "d"_sym;
+  EXPECT_EQ(data, body.data());
+  EXPECT_EQ(Symbol_String({"a"_sym, "b"_sym, "c"_sym, "d"_sym}), body);
+
+  Symbol_String const tail {"e"_sym, "f"_sym};
+  EXPECT_EQ(Symbol_String({"a"_sym, "e"_sym, "f"_sym}), "a"_sym + tail);
+  EXPECT_EQ(Symbol_String({"e"_sym, "f"_sym, "a"_sym}), tail + "a"_sym);
+  EXPECT_EQ(Symbol_String({"e"_sym, "f"_sym, "e"_sym, "f"_sym}), tail + tail);
+
+  auto alternatives = "a"_sym + "b"_sym | "c"_sym + "d"_sym;
+  auto const * first = alternatives.data();
+  alternatives = std::move(alternatives) | "e"_sym + "f"_sym | Symbol::empty();
+  EXPECT_EQ(first, alternatives.data());
+  EXPECT_EQ(Symbol_String_Alternatives({
+    {"a"_sym, "b"_sym}, {"c"_sym, "d"_sym}, {"e"_sym, "f"_sym}, {Symbol::empty()}
+  }), alternatives);
+
+  Symbol_String_Alternatives const copied = tail | tail;
+  EXPECT_EQ(3u, (copied | tail).size());
+  EXPECT_EQ(2u, copied.size());
 }
 
 // (4.30)
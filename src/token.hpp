@@ -3,8 +3,60 @@
 #include "string.hpp"
 #include "symbol.hpp"
 
+#include <algorithm>
+
 namespace parka {
 
+/**
+ * Characters of a lexeme within a buffer owned elsewhere (typically by the
+ * lexer), so the lexeme is only copied into a string if it is needed.
+ */
+class Lexeme_View {
+  char_type const * data_;
+  size_t size_;
+
+public:
+  Lexeme_View() : data_(nullptr), size_(0) {}
+  Lexeme_View(char_type const * data, size_t size) : data_(data), size_(size) {}
+
+  char_type const * data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  char_type const * begin() const { return data_; }
+  char_type const * end() const { return data_ + size_; }
+
+  string str() const { return string(data_, size_); }
+  operator string() const { return str(); }
+
+  bool operator==(Lexeme_View const & other) const {
+    return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+  }
+
+  bool operator!=(Lexeme_View const & other) const {
+    return !((*this) == other);
+  }
+};
+
+inline bool operator==(Lexeme_View const & lhs, string const & rhs) { return lhs == Lexeme_View(rhs.data(), rhs.size()); }
+inline bool operator==(string const & lhs, Lexeme_View const & rhs) { return rhs == lhs; }
+inline bool operator!=(Lexeme_View const & lhs, string const & rhs) { return !(lhs == rhs); }
+inline bool operator!=(string const & lhs, Lexeme_View const & rhs) { return !(rhs == lhs); }
+
+
+/**
+ * A token which refers to its lexeme in the buffer it was lexed from, rather
+ * than owning a copy.  Only valid as long as that buffer is.
+ */
+struct Token_View {
+  Symbol symbol;
+  Lexeme_View lexeme;
+
+  Token_View() = default;
+  Token_View(Symbol const & symbol, Lexeme_View lexeme) : symbol(symbol), lexeme(lexeme) {}
+};
+
+
 /**
 * The atomic unit created by the lexer.
 */
@@ -16,6 +68,7 @@ struct Token {
 
   explicit Token(Symbol const & symbol) : symbol(symbol), lexeme(symbol.repr()) {}
   Token(Symbol const & symbol, string const & lexeme) : symbol(symbol), lexeme(lexeme) {}
+  explicit Token(Token_View const & view) : symbol(view.symbol), lexeme(view.lexeme.str()) {}
 
   // Per "Modern C++" item 17.
   // Having "null" tokens isn't the worst thing here,
@@ -28,4 +81,4 @@ struct Token {
   Token& operator=(Token&&) = default;
 };
 
-} // namespace parka
\ No newline at end of file
+} // namespace parka
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "symbol.hpp"
+#include "token.hpp"
+
+#include <cstddef>
+#include <iterator>
+
+namespace parka {
+
+/**
+ * An input range over the tokens of a lexer (`Lexer` or `Stream_Lexer`), which
+ * takes each token from the lexer only as the iterator reaches it.  Handing
+ * one to `predictive_parse` lets lexing and parsing interleave without ever
+ * storing the whole token list.
+ *
+ * After the lexer's last token, the range gives a right end marker token ($),
+ * as the parsers expect at the end of their input.  Dereferencing an iterator
+ * beyond that continues to give the end marker.
+ *
+ * Like any input range, only one pass can be made, and copies of an iterator
+ * all advance together.
+ */
+template <typename Token_Source>
+class Token_Range {
+  Token_Source * source_;
+  Token_View current_;
+  bool started_;
+  bool at_end_marker_;
+  bool finished_;
+
+  void advance()
+  {
+    if (source_->has_next_token()) {
+      current_ = source_->next_token_view();
+    }
+    else if (!at_end_marker_) {
+      current_ = Token_View(Symbol::right_end_marker(), Lexeme_View());
+      at_end_marker_ = true;
+    }
+    else {
+      finished_ = true;
+    }
+  }
+
+public:
+  using value_type = Token_View;
+
+  class iterator {
+    Token_Range * range_;
+
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Token_View;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Token_View const *;
+    using reference = Token_View const &;
+
+    explicit iterator(Token_Range * range = nullptr) : range_(range) {}
+
+    reference operator*() const { return range_->current_; }
+    pointer operator->() const { return &range_->current_; }
+
+    iterator & operator++()
+    {
+      range_->advance();
+      return *this;
+    }
+
+    void operator++(int) { ++(*this); }
+
+    bool operator==(iterator const & other) const { return is_end() == other.is_end(); }
+    bool operator!=(iterator const & other) const { return !((*this) == other); }
+
+  private:
+    bool is_end() const { return range_ == nullptr || range_->finished_; }
+  };
+
+  explicit Token_Range(Token_Source & source)
+    : source_(&source)
+    , started_(false)
+    , at_end_marker_(false)
+    , finished_(false)
+  {
+  }
+
+  iterator begin()
+  {
+    if (!started_) {
+      started_ = true;
+      advance();
+    }
+    return iterator(this);
+  }
+
+  iterator end() { return iterator(); }
+};
+
+
+template <typename Token_Source>
+Token_Range<Token_Source>
+token_range(Token_Source & source)
+{
+  return Token_Range<Token_Source>(source);
+}
+
+} // namespace parka